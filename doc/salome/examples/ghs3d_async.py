@@ -0,0 +1,49 @@
+# Asynchronous computation with MG-Tetra algorithm
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+box = geompy.MakeBoxDXDYDZ(200., 200., 200.)
+geompy.addToStudy(box, "box")
+
+# start computing a mesh in a separate thread
+mgtetraMesh = smesh.Mesh(box,"box: asynchronous MG-Tetra mesh")
+MG_CADSurf = mgtetraMesh.Triangle(algo=smeshBuilder.MG_CADSurf)
+MG_Tetra = mgtetraMesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+ok = MG_Tetra.StartCompute()
+if not ok:
+  raise Exception("Error when starting computation of mgtetraMesh")
+
+# watch the progress while waiting for the end of the computation
+while not MG_Tetra.WaitCompute(0.5):
+  print("state:", MG_Tetra.GetComputeState(), "progress:", MG_Tetra.GetComputeProgress())
+
+if MG_Tetra.GetComputeState() != smeshBuilder.COMPUTE_DONE:
+  raise Exception("Error when computing mgtetraMesh")
+assert MG_Tetra.GetComputeProgress() == 1.
+
+volume = smesh.GetVolume(mgtetraMesh)
+expected_volume = 200**3
+assert abs(volume-expected_volume)/expected_volume < 1e-12
+
+# start computing a fine mesh and cancel the computation
+fineMesh = smesh.Mesh(box,"box: canceled MG-Tetra mesh")
+fineMesh.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(2.)
+MG_Tetra = fineMesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+ok = MG_Tetra.StartCompute()
+if not ok:
+  raise Exception("Error when starting computation of fineMesh")
+
+MG_Tetra.CancelCompute()
+ok = MG_Tetra.WaitCompute()
+assert ok
+assert MG_Tetra.GetComputeState() == smeshBuilder.COMPUTE_CANCELED
+assert fineMesh.NbTetras() == 0
+
+# End of script
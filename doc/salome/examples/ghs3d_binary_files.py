@@ -0,0 +1,37 @@
+# Exchange of binary mesh files with MG-Tetra executable
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+cylinder = geompy.MakeCylinderRH(50., 200.)
+geompy.addToStudy(cylinder, "cylinder")
+
+# mesh the cylinder with ASCII files and with binary files
+meshes = []
+for useBinary in [False, True]:
+  mesh = smesh.Mesh(cylinder,"cylinder: binary files %s" % useBinary)
+  mesh.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(10.)
+  MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+  MG_Tetra.SetUseBinaryFiles(useBinary)
+  ok = mesh.Compute()
+  if not ok:
+    raise Exception("Error when computing mesh with binary files %s" % useBinary)
+  meshes.append(mesh)
+
+asciiMesh, binaryMesh = meshes
+
+# both meshes fill the same triangulated surface
+assert binaryMesh.NbTetras() > 0
+assert binaryMesh.NbTriangles() == asciiMesh.NbTriangles()
+
+volume = smesh.GetVolume(binaryMesh)
+expected_volume = smesh.GetVolume(asciiMesh)
+assert abs(volume-expected_volume)/expected_volume < 1e-9
+
+# End of script
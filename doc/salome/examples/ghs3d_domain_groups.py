@@ -0,0 +1,56 @@
+# Groups of domains and of enforced vertices created by MG-Tetra algorithm
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+import SMESH
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+# a box inside another box
+outerBox = geompy.MakeBoxDXDYDZ(200., 200., 200.)
+innerBox = geompy.MakeBoxTwoPnt(geompy.MakeVertex(50., 50., 50.),
+                                geompy.MakeVertex(150., 150., 150.))
+geompy.addToStudy(outerBox, "outerBox")
+geompy.addToStudy(innerBox, "innerBox")
+
+# triangulate the boxes
+surfaces = []
+for box in [outerBox, innerBox]:
+  surface = smesh.Mesh(box)
+  surface.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(25.)
+  ok = surface.Compute()
+  if not ok:
+    raise Exception("Error when computing surface mesh")
+  surfaces.append(surface.GetMesh())
+
+# mesh the two domains bounded by the surfaces
+mesh = smesh.Concatenate(surfaces, 0, name="two domains")
+MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+MG_Tetra.SetToMeshHoles(True)
+MG_Tetra.SetToMakeGroupsOfDomains(True)
+MG_Tetra.SetEnforcedVertex(20., 20., 20., 5., groupName="enforced vertex")
+ok = mesh.Compute()
+if not ok:
+  raise Exception("Error when computing mesh")
+
+# check groups of domains
+domainGroups = [g for g in mesh.GetGroups() if g.GetName().startswith("Domain_")]
+assert len(domainGroups) == 2
+volumes = sorted([smesh.GetVolume(g) for g in domainGroups])
+expected_volumes = [100**3, 200**3 - 100**3]
+for volume, expected_volume in zip(volumes, expected_volumes):
+  assert abs(volume-expected_volume)/expected_volume < 1e-9
+assert sum([g.Size() for g in domainGroups]) == mesh.NbVolumes()
+
+# check the group of the enforced vertex
+group = mesh.GetGroupByName("enforced vertex")[0]
+assert group.GetType() == SMESH.NODE
+assert group.Size() == 1
+nodeXYZ = mesh.GetNodeXYZ(group.GetIDs()[0])
+assert abs(nodeXYZ[0]-20.) + abs(nodeXYZ[1]-20.) + abs(nodeXYZ[2]-20.) < 1e-7
+
+# End of script
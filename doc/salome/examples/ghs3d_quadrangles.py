@@ -0,0 +1,33 @@
+# Meshing of a volume bounded by quadrangles with MG-Tetra algorithm.
+# Quadrangles are bound by pyramids, whose triangles are passed to MG-Tetra.
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+box = geompy.MakeBoxDXDYDZ(200., 200., 200.)
+geompy.addToStudy(box, "box")
+
+mesh = smesh.Mesh(box,"box: quadrangles and MG-Tetra")
+mesh.Segment().NumberOfSegments(10)
+mesh.Quadrangle()
+MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+ok = mesh.Compute()
+if not ok:
+  raise Exception("Error when computing mesh")
+
+# each quadrangle is a base of a pyramid
+assert mesh.NbQuadrangles() == 6 * 10 * 10
+assert mesh.NbPyramids() == mesh.NbQuadrangles()
+assert mesh.NbTetras() > 0
+
+volume = smesh.GetVolume(mesh)
+expected_volume = 200**3
+assert abs(volume-expected_volume)/expected_volume < 1e-12
+
+# End of script
@@ -0,0 +1,43 @@
+# Sorting of nodes passed to MG-Tetra and renumbering of the result
+# for locality of nodes and elements in memory
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+import SMESH
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+sphere = geompy.MakeSphereR(100.)
+geompy.addToStudy(sphere, "sphere")
+
+# mesh the sphere as usual and with sorting and renumbering
+meshes = []
+for toSort in [False, True]:
+  mesh = smesh.Mesh(sphere,"sphere: sorted and renumbered %s" % toSort)
+  mesh.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(10.)
+  MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+  MG_Tetra.SetToSortInputNodes(toSort)
+  MG_Tetra.SetToRenumberResult(toSort)
+  ok = mesh.Compute()
+  if not ok:
+    raise Exception("Error when computing mesh with sorting %s" % toSort)
+  meshes.append(mesh)
+
+usualMesh, sortedMesh = meshes
+assert sortedMesh.NbTetras() > 0
+
+# all volumes are valid, i.e. connectivity is not broken by renumbering
+minVolume, maxVolume = sortedMesh.GetMinMax(SMESH.FT_Volume3D)
+assert minVolume > 0
+
+# both meshes fill the same triangulated surface
+assert sortedMesh.NbTriangles() == usualMesh.NbTriangles()
+volume = smesh.GetVolume(sortedMesh)
+expected_volume = smesh.GetVolume(usualMesh)
+assert abs(volume-expected_volume)/expected_volume < 1e-9
+
+# End of script
@@ -0,0 +1,49 @@
+# Meshing of solids of a shape by concurrent MG-Tetra runs
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+import SMESH
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+# a box split into three solids sharing faces
+box = geompy.MakeBoxDXDYDZ(300., 100., 100.)
+planes = [geompy.MakePlane(geompy.MakeVertex(x, 0., 0.), geompy.MakeVectorDXDYDZ(1., 0., 0.), 500.)
+          for x in [100., 200.]]
+solids = geompy.MakePartition([box], planes)
+geompy.addToStudy(solids, "solids")
+assert geompy.NumberOfSolids(solids) == 3
+
+mesh = smesh.Mesh(solids,"solids: concurrent MG-Tetra runs")
+mesh.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(10.)
+MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+MG_Tetra.SetToMeshSolidsConcurrently(True)
+ok = mesh.Compute()
+if not ok:
+  raise Exception("Error when computing mesh")
+
+# each solid is meshed
+for solid in geompy.SubShapeAllSorted(solids, geompy.ShapeType["SOLID"]):
+  volume = smesh.GetVolume(mesh.GetSubMesh(solid, "solid"))
+  expected_volume = 100**3
+  assert abs(volume-expected_volume)/expected_volume < 1e-12
+
+# the mesh is conformal: faces shared by solids are bound by two volumes
+sharedFaces = geompy.GetSharedShapesMulti(solids, geompy.ShapeType["FACE"], False)
+assert len(sharedFaces) == 2
+for i, face in enumerate(sharedFaces):
+  geompy.addToStudyInFather(solids, face, "sharedFace_%s" % i)
+  freeFaces = smesh.GetFilterFromCriteria(
+    [ smesh.GetCriterion(SMESH.FACE, SMESH.FT_FreeFaces, BinaryOp=SMESH.FT_LogicalAND),
+      smesh.GetCriterion(SMESH.FACE, SMESH.FT_BelongToGeom, SMESH.FT_Undefined, face) ])
+  assert len(mesh.GetIdsFromFilter(freeFaces)) == 0
+
+volume = smesh.GetVolume(mesh)
+expected_volume = 300 * 100**2
+assert abs(volume-expected_volume)/expected_volume < 1e-12
+
+# End of script
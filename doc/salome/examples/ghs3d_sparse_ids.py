@@ -0,0 +1,61 @@
+# Meshing of a triangulated surface whose node IDs are not contiguous,
+# with nodes of another mesh enforced
+
+import salome
+salome.salome_init()
+
+from salome.geom import geomBuilder
+geompy = geomBuilder.New()
+
+import SMESH
+from salome.smesh import smeshBuilder
+smesh =  smeshBuilder.New()
+
+box = geompy.MakeBoxDXDYDZ(200., 200., 200.)
+geompy.addToStudy(box, "box")
+
+# triangulate the box
+Mesh_box_tri = smesh.Mesh(box,"Mesh_box_tri")
+Mesh_box_tri.Triangle(algo=smeshBuilder.MG_CADSurf).SetPhySize(40.)
+ok = Mesh_box_tri.Compute()
+if not ok:
+  raise Exception("Error when computing Mesh_box_tri")
+
+# put the triangles after free nodes and remove the free nodes,
+# so that node IDs of the surface start far from one
+freeNodes = smesh.Mesh()
+for i in range(100):
+  freeNodes.AddNode(-1., -1., float(i))
+mesh = smesh.Concatenate([freeNodes.GetMesh(), Mesh_box_tri.GetMesh()], 0,
+                         name="sparse IDs")
+mesh.RemoveOrphanNodes()
+assert min(mesh.GetNodesId()) > 100
+
+# nodes of another mesh to enforce
+innerPoints = [(50., 50., 50.), (100., 100., 100.), (150., 120., 30.)]
+innerNodes = smesh.Mesh()
+for x,y,z in innerPoints:
+  innerNodes.AddNode(x, y, z)
+
+MG_Tetra = mesh.Tetrahedron(algo=smeshBuilder.MG_Tetra)
+MG_Tetra.SetEnforcedMesh(innerNodes.GetMesh(), SMESH.NODE, groupName="inner nodes")
+ok = mesh.Compute()
+if not ok:
+  raise Exception("Error when computing mesh")
+
+# check the volume and that the surface is kept
+volume = smesh.GetVolume(mesh)
+expected_volume = 200**3
+assert abs(volume-expected_volume)/expected_volume < 1e-12
+area = smesh.GetArea(mesh)
+expected_area = 6 * 200**2
+assert abs(area-expected_area)/expected_area < 1e-12
+
+# check that the enforced nodes are in the mesh
+group = mesh.GetGroupByName("inner nodes")[0]
+assert group.Size() == len(innerPoints)
+for x,y,z in innerPoints:
+  nodeXYZ = mesh.GetNodeXYZ(mesh.FindNodeClosestTo(x, y, z))
+  assert abs(nodeXYZ[0]-x) + abs(nodeXYZ[1]-y) + abs(nodeXYZ[2]-z) < 1e-7
+
+# End of script
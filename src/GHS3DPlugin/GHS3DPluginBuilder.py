@@ -42,6 +42,7 @@ None_Optimization, Light_Optimization, Standard_Optimization, StandardPlus_Optim
 # import items of enums
 for e in GHS3DPlugin.Mode._items: exec('%s = GHS3DPlugin.%s'%(e,e))
 for e in GHS3DPlugin.PThreadsMode._items: exec('%s = GHS3DPlugin.%s'%(e,e))
+for e in GHS3DPlugin.ComputeState._items: exec('%s = GHS3DPlugin.%s'%(e,e))
 Mode_NO, Mode_YES, Mode_ONLY = GHS3DPlugin.Mode._items
 Mode_SAFE, Mode_AGGRESSIVE, Mode_NONE = GHS3DPlugin.PThreadsMode._items
 
@@ -173,6 +174,36 @@ class GHS3D_Algorithm(Mesh_Algorithm):
     def SetRemoveLogOnSuccess(self, toRemove):
         self.Parameters().SetRemoveLogOnSuccess(toRemove)
         pass
+
+    ## To exchange binary .meshb/.solb files with MG-Tetra executable instead of
+    #  ASCII .mesh/.sol ones. MG_TETRA_USE_BINARY_FILES environment variable
+    #  overrides this flag.
+    #  @param toUseBinary "use binary files" flag value
+    def SetUseBinaryFiles(self, toUseBinary):
+        self.Parameters().SetUseBinaryFiles(toUseBinary)
+        pass
+
+    ## To pass surface nodes to MG-Tetra sorted along a Hilbert curve, which
+    #  improves memory locality when meshing very large models
+    #  @param toSort "sort input nodes" flag value
+    def SetToSortInputNodes(self, toSort):
+        self.Parameters().SetToSortInputNodes(toSort)
+        pass
+
+    ## To create nodes generated by MG-Tetra in the order of a Hilbert curve and
+    #  volumes sorted by sub-domain and then by nodes, which suits solvers better
+    #  @param toRenumber "renumber result" flag value
+    def SetToRenumberResult(self, toRenumber):
+        self.Parameters().SetToRenumberResult(toRenumber)
+        pass
+
+    ## To mesh each solid of a multi-solid shape by a separate MG-Tetra run,
+    #  several runs being executed concurrently. Not used along with
+    #  enforced entities, viscous layers or groups of domains
+    #  @param toMeshConcurrently "mesh solids concurrently" flag value
+    def SetToMeshSolidsConcurrently(self, toMeshConcurrently):
+        self.Parameters().SetToMeshSolidsConcurrently(toMeshConcurrently)
+        pass
     
     ## Print the the log in a file. If set to false, the
     # log is printed on the standard output
@@ -344,6 +375,38 @@ class GHS3D_Algorithm(Mesh_Algorithm):
     def SetTextOption(self, option):
         self.Parameters().SetAdvancedOption(option)
         pass
+
+    ## Starts computing the mesh in a separate thread and returns immediately.
+    #  All algorithms assigned to the mesh are run, as by Mesh.Compute().
+    #  Only one mesh at a time can be computed by the SMESH engine: until
+    #  WaitCompute() returns True, MG-Tetra fails to compute other meshes,
+    #  and neither other meshes should be computed nor this mesh be queried
+    #  or modified, as other algorithms do not check it.
+    #  @return False if a previous computation is not finished or if
+    #          another mesh is being computed asynchronously
+    def StartCompute(self):
+        return self.algo.StartCompute(self.mesh.GetMesh())
+
+    ## Returns stage of a computation started by StartCompute(), one of
+    #  COMPUTE_NOT_STARTED, COMPUTE_PREPARING, COMPUTE_WRITING_INPUT, COMPUTE_MESHING,
+    #  COMPUTE_READING_OUTPUT, COMPUTE_DONE, COMPUTE_FAILED, COMPUTE_CANCELED
+    def GetComputeState(self):
+        return self.algo.GetComputeState()
+
+    ## Returns progress [0.,1.] of a computation started by StartCompute()
+    def GetComputeProgress(self):
+        return self.algo.GetComputeProgress()
+
+    ## Waits for the end of a computation started by StartCompute()
+    #  @param timeout max time to wait in seconds; negative means no limit
+    #  @return True if the computation is finished
+    def WaitCompute(self, timeout=-1):
+        return self.algo.WaitCompute(timeout)
+
+    ## Cancels a computation started by StartCompute()
+    def CancelCompute(self):
+        self.algo.CancelCompute()
+        pass
     
     pass # end of GHS3D_Algorithm class
 
@@ -479,6 +542,14 @@ class GHS3D_Optimizer(GHS3D_Algorithm):
         self.Parameters().SetRemoveLogOnSuccess(toRemove)
         pass
 
+    ## To exchange binary .meshb/.solb files with MG-Tetra executable instead of
+    #  ASCII .mesh/.sol ones. MG_TETRA_USE_BINARY_FILES environment variable
+    #  overrides this flag.
+    #  @param toUseBinary "use binary files" flag value
+    def SetUseBinaryFiles(self, toUseBinary):
+        self.Parameters().SetUseBinaryFiles(toUseBinary)
+        pass
+
     ## Print the the log in a file. If set to false, the
     # log is printed on the standard output
     #  @param toPrintLogInFile "print log in a file" flag value
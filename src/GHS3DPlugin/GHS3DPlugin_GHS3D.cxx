@@ -27,14 +27,17 @@
 #include "GHS3DPlugin_GHS3D.hxx"
 #include "GHS3DPlugin_Hypothesis.hxx"
 #include "MG_Tetra_API.hxx"
+#include "MG_Tetra_Budget.hxx"
 
 #include <SMDS_FaceOfNodes.hxx>
 #include <SMDS_LinearEdge.hxx>
 #include <SMDS_MeshElement.hxx>
 #include <SMDS_MeshNode.hxx>
+#include <SMDS_SpacePosition.hxx>
 #include <SMDS_VolumeOfNodes.hxx>
 #include <SMESHDS_Group.hxx>
 #include <SMESHDS_Mesh.hxx>
+#include <SMESHDS_SubMesh.hxx>
 #include <SMESH_Comment.hxx>
 #include <SMESH_File.hxx>
 #include <SMESH_Group.hxx>
@@ -57,9 +60,11 @@
 #include <BRepGProp.hxx>
 #include <BRepTools.hxx>
 #include <BRep_Tool.hxx>
+#include <Bnd_B3d.hxx>
 #include <Bnd_Box.hxx>
 #include <GProp_GProps.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <OSD_Parallel.hxx>
 #include <Precision.hxx>
 #include <Standard_ErrorHandler.hxx>
 #include <Standard_Failure.hxx>
@@ -77,7 +82,19 @@
 #include <utilities.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <errno.h>
+#include <exception>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 
@@ -144,7 +161,8 @@ static void removeFile( const TCollection_AsciiString& fileName )
 //=============================================================================
 
 GHS3DPlugin_GHS3D::GHS3DPlugin_GHS3D(int hypId, SMESH_Gen* gen)
-  : SMESH_3D_Algo(hypId, gen), _isLibUsed( false )
+  : SMESH_3D_Algo(hypId, gen),
+    _asyncMesh( 0 ), _computeState( COMPUTE_NOT_STARTED ), _isAsyncCanceled( false )
 {
   _name = Name();
   _shapeType = (1 << TopAbs_SHELL) | (1 << TopAbs_SOLID);// 1 bit /shape type
@@ -167,6 +185,8 @@ GHS3DPlugin_GHS3D::GHS3DPlugin_GHS3D(int hypId, SMESH_Gen* gen)
 
 GHS3DPlugin_GHS3D::~GHS3DPlugin_GHS3D()
 {
+  CancelAsyncCompute();
+  WaitCompute( -1 );
 }
 
 //=============================================================================
@@ -289,6 +309,144 @@ static int checkTmpFace(const SMDS_MeshNode* node1,
   return HOLE_ID;
 }
 
+namespace
+{
+  //=======================================================================
+  /*!
+   * \brief Solids bounded by geometrical faces, found once per face and
+   *        reused for all MG-Tetra sub-domains indicated by triangles of the face
+   */
+  //=======================================================================
+
+  class TFaceAncestry
+  {
+  public:
+
+    struct TFaceData
+    {
+      bool        _isNormalNeeded; // true if _resultID depends on triangle orientation
+      int         _resultID;       // solid ID if !_isNormalNeeded
+      int         _solid1, _solid2;// solids at the face side and opposite to it
+      TopoDS_Face _face;           // face oriented as in _solid1
+      std::unique_ptr< SMESH_MesherHelper >  _helper;
+      std::unique_ptr< BRepAdaptor_Surface > _surface;
+
+      TFaceData(): _isNormalNeeded( false ), _resultID( 0 ), _solid1( 0 ), _solid2( HOLE_ID ) {}
+    };
+
+    TFaceAncestry( SMESH_Mesh& mesh, bool toMeshHoles )
+      : _mesh( mesh ), _editor( &mesh ), _toMeshHoles( toMeshHoles ) {}
+
+    SMESH_Mesh&       Mesh()   { return _mesh; }
+    SMESH_MeshEditor& Editor() { return _editor; }
+
+    const TFaceData& Get( int geomFaceID )
+    {
+      std::pair< TDataMap::iterator, bool > it_isNew =
+        _data.insert( std::make_pair( geomFaceID, TFaceData() ));
+      if ( it_isNew.second )
+        analyse( geomFaceID, it_isNew.first->second );
+      return it_isNew.first->second;
+    }
+
+  private:
+
+    void analyse( int geomFaceID, TFaceData& data );
+
+    typedef std::map< int, TFaceData > TDataMap;
+
+    SMESH_Mesh&      _mesh;
+    SMESH_MeshEditor _editor;
+    bool             _toMeshHoles;
+    TDataMap         _data;
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Find solids of a geom face and decide if triangle orientation
+   *        is needed to choose one of them
+   */
+  //=======================================================================
+
+  void TFaceAncestry::analyse( int geomFaceID, TFaceData& data )
+  {
+    const int invalidID = 0;
+    data._resultID = invalidID;
+
+    SMESHDS_Mesh* meshDS = _mesh.GetMeshDS();
+    TopoDS_Shape shape = meshDS->IndexToShape( geomFaceID );
+    if ( shape.IsNull() || shape.ShapeType() != TopAbs_FACE )
+      return;
+    TopoDS_Face geomFace = TopoDS::Face( shape );
+
+    // solids bounded by geom face
+    TopTools_IndexedMapOfShape solids, shells;
+    TopTools_ListIteratorOfListOfShape ansIt = _mesh.GetAncestors(geomFace);
+    for ( ; ansIt.More(); ansIt.Next() ) {
+      switch ( ansIt.Value().ShapeType() ) {
+      case TopAbs_SOLID:
+        solids.Add( ansIt.Value() ); break;
+      case TopAbs_SHELL:
+        shells.Add( ansIt.Value() ); break;
+      default:;
+      }
+    }
+    // analyse found solids
+    if ( solids.Extent() == 0 || shells.Extent() == 0)
+      return;
+
+    const TopoDS_Solid& solid1 = TopoDS::Solid( solids(1) );
+    data._solid1 = meshDS->ShapeToIndex( solid1 );
+    if ( solids.Extent() == 1 )
+    {
+      if ( _toMeshHoles )
+      {
+        data._resultID = data._solid1;
+        return;
+      }
+      // - Are we at a hole boundary face?
+      if ( shells(1).IsSame( BRepClass3d::OuterShell( solid1 )) )
+      { // - No, but maybe a hole is bound by two shapes? Does shells(1) touch another shell?
+        bool touch = false;
+        TopExp_Explorer eExp( shells(1), TopAbs_EDGE );
+        // check if any edge of shells(1) belongs to another shell
+        for ( ; eExp.More() && !touch; eExp.Next() ) {
+          ansIt = _mesh.GetAncestors( eExp.Current() );
+          for ( ; ansIt.More() && !touch; ansIt.Next() ) {
+            if ( ansIt.Value().ShapeType() == TopAbs_SHELL )
+              touch = ( !ansIt.Value().IsSame( shells(1) ));
+          }
+        }
+        if (!touch)
+        {
+          data._resultID = data._solid1;
+          return;
+        }
+      }
+      data._solid2 = HOLE_ID; // we are inside a hole
+    }
+    else
+    {
+      data._solid2 = meshDS->ShapeToIndex( solids(2) );
+    }
+    // find orientation of geom face within the first solid
+    TopExp_Explorer fExp( solid1, TopAbs_FACE );
+    for ( ; fExp.More(); fExp.Next() )
+      if ( geomFace.IsSame( fExp.Current() )) {
+        geomFace = TopoDS::Face( fExp.Current() );
+        break;
+      }
+    if ( !fExp.More() )
+      return; // face not found
+
+    data._face = geomFace;
+    data._helper.reset( new SMESH_MesherHelper( _mesh ));
+    data._helper->SetSubShape( geomFace );
+    data._surface.reset( new BRepAdaptor_Surface( geomFace ));
+    data._isNormalNeeded = true;
+  }
+}
+
 //=======================================================================
 //function : findShapeID
 //purpose  : find the solid corresponding to MG-Tetra sub-domain following
@@ -298,14 +456,13 @@ static int checkTmpFace(const SMDS_MeshNode* node1,
 //           points out of the domain it is associated to
 //=======================================================================
 
-static int findShapeID(SMESH_Mesh&          mesh,
+static int findShapeID(TFaceAncestry&       faceAncestry,
                        const SMDS_MeshNode* node1,
                        const SMDS_MeshNode* node2,
-                       const SMDS_MeshNode* node3,
-                       const bool           toMeshHoles)
+                       const SMDS_MeshNode* node3)
 {
   const int invalidID = 0;
-  SMESHDS_Mesh* meshDS = mesh.GetMeshDS();
+  SMESHDS_Mesh* meshDS = faceAncestry.Mesh().GetMeshDS();
 
   // face the nodes belong to
   vector<const SMDS_MeshNode *> nodes(3);
@@ -319,63 +476,18 @@ static int findShapeID(SMESH_Mesh&          mesh,
   std::cout << "bnd face " << face->GetID() << " - ";
 #endif
   // geom face the face assigned to
-  SMESH_MeshEditor editor(&mesh);
-  int geomFaceID = editor.FindShape( face );
+  int geomFaceID = faceAncestry.Editor().FindShape( face );
   if ( !geomFaceID )
     return checkTmpFace(node1, node2, node3);
-  TopoDS_Shape shape = meshDS->IndexToShape( geomFaceID );
-  if ( shape.IsNull() || shape.ShapeType() != TopAbs_FACE )
-    return invalidID;
-  TopoDS_Face geomFace = TopoDS::Face( shape );
 
   // solids bounded by geom face
-  TopTools_IndexedMapOfShape solids, shells;
-  TopTools_ListIteratorOfListOfShape ansIt = mesh.GetAncestors(geomFace);
-  for ( ; ansIt.More(); ansIt.Next() ) {
-    switch ( ansIt.Value().ShapeType() ) {
-    case TopAbs_SOLID:
-      solids.Add( ansIt.Value() ); break;
-    case TopAbs_SHELL:
-      shells.Add( ansIt.Value() ); break;
-    default:;
-    }
-  }
-  // analyse found solids
-  if ( solids.Extent() == 0 || shells.Extent() == 0)
-    return invalidID;
+  const TFaceAncestry::TFaceData& faceData = faceAncestry.Get( geomFaceID );
+  if ( !faceData._isNormalNeeded )
+    return faceData._resultID;
 
-  const TopoDS_Solid& solid1 = TopoDS::Solid( solids(1) );
-  if ( solids.Extent() == 1 )
-  {
-    if ( toMeshHoles )
-      return meshDS->ShapeToIndex( solid1 );
-
-    // - Are we at a hole boundary face?
-    if ( shells(1).IsSame( BRepClass3d::OuterShell( solid1 )) )
-    { // - No, but maybe a hole is bound by two shapes? Does shells(1) touch another shell?
-      bool touch = false;
-      TopExp_Explorer eExp( shells(1), TopAbs_EDGE );
-      // check if any edge of shells(1) belongs to another shell
-      for ( ; eExp.More() && !touch; eExp.Next() ) {
-        ansIt = mesh.GetAncestors( eExp.Current() );
-        for ( ; ansIt.More() && !touch; ansIt.Next() ) {
-          if ( ansIt.Value().ShapeType() == TopAbs_SHELL )
-            touch = ( !ansIt.Value().IsSame( shells(1) ));
-        }
-      }
-      if (!touch)
-        return meshDS->ShapeToIndex( solid1 );
-    }
-  }
-  // find orientation of geom face within the first solid
-  TopExp_Explorer fExp( solid1, TopAbs_FACE );
-  for ( ; fExp.More(); fExp.Next() )
-    if ( geomFace.IsSame( fExp.Current() )) {
-      geomFace = TopoDS::Face( fExp.Current() );
-      break;
-    }
-  if ( !fExp.More() )
-    return invalidID; // face not found
+  const TopoDS_Face&   geomFace = faceData._face;
+  SMESH_MesherHelper&    helper = *faceData._helper;
+  BRepAdaptor_Surface&  surface = *faceData._surface;
 
   // normale to triangle
   gp_Pnt node1Pnt ( node1->X(), node1->Y(), node1->Z() );
@@ -390,7 +502,6 @@ static int findShapeID(SMESH_Mesh&          mesh,
   // get normale to geomFace at any node
   bool geomNormalOK = false;
   gp_Vec geomNormal;
-  SMESH_MesherHelper helper( mesh ); helper.SetSubShape( geomFace );
   for ( int i = 0; !geomNormalOK && i < 3; ++i )
   {
     // find UV of i-th node on geomFace
@@ -416,7 +527,6 @@ static int findShapeID(SMESH_Mesh&          mesh,
         default:;
         }
       gp_Pnt nodePnt ( nodes[i]->X(), nodes[i]->Y(), nodes[i]->Z() );
-      BRepAdaptor_Surface surface( geomFace );
       uvOK = ( nodePnt.Distance( surface.Value( uv.X(), uv.Y() )) < 2 * tol );
       if ( uvOK ) {
         // normale to geomFace at UV
@@ -434,54 +544,118 @@ static int findShapeID(SMESH_Mesh&          mesh,
 
   // compare normals
   bool isReverse = ( meshNormal * geomNormal ) < 0;
-  if ( !isReverse )
-    return meshDS->ShapeToIndex( solid1 );
-
-  if ( solids.Extent() == 1 )
-    return HOLE_ID; // we are inside a hole
-  else
-    return meshDS->ShapeToIndex( solids(2) );
+  return isReverse ? faceData._solid2 : faceData._solid1;
 }
 
-//=======================================================================
-//function : addElemInMeshGroup
-//purpose  : Update or create groups in mesh
-//=======================================================================
-
-static void addElemInMeshGroup(SMESH_Mesh*             theMesh,
-                               const SMDS_MeshElement* anElem,
-                               std::string&            groupName,
-                               std::set<std::string>&  /*groupsToRemove*/)
+namespace
 {
-  if ( !anElem ) return; // issue 0021776
+  //=======================================================================
+  /*!
+   * \brief Groups of elements created by one compute.
+   *
+   * Group names are interned: an element refers to a group by an ID, 0 means
+   * "no group". Elements are collected per group (type + name) and are added
+   * to SMESH groups at once by Flush(), which looks through mesh groups only once.
+   */
+  //=======================================================================
 
-  bool groupDone = false;
-  SMESH_Mesh::GroupIteratorPtr grIt = theMesh->GetGroups();
-  while (grIt->more()) {
-    SMESH_Group * group = grIt->next();
-    if ( !group ) continue;
-    SMESHDS_GroupBase* groupDS = group->GetGroupDS();
-    if ( !groupDS ) continue;
-    if ( groupDS->GetType()==anElem->GetType() &&groupName.compare(group->GetName())==0) {
-      SMESHDS_Group* aGroupDS = static_cast<SMESHDS_Group*>( groupDS );
-      aGroupDS->SMDSGroup().Add(anElem);
-      groupDone = true;
-      break;
-    }
-  }
-  
-  if (!groupDone)
+  class TGroupIndex
   {
-    SMESH_Group* aGroup = theMesh->AddGroup(anElem->GetType(), groupName.c_str());
-    aGroup->SetName( groupName.c_str() );
-    SMESHDS_Group* aGroupDS = static_cast<SMESHDS_Group*>( aGroup->GetGroupDS() );
-    aGroupDS->SMDSGroup().Add(anElem);
-    groupDone = true;
-  }
-  if (!groupDone)
-    throw SALOME_Exception(LOCALIZED("A given element was not added to a group"));
-}
+  public:
+
+    TGroupIndex(): _names( 1 ) {}
+
+    int Intern( const std::string& name )
+    {
+      if ( name.empty() )
+        return 0;
+      std::pair< TIDByName::iterator, bool > it_isNew =
+        _idByName.insert( std::make_pair( name, int( _names.size() )));
+      if ( it_isNew.second )
+        _names.push_back( name );
+      return it_isNew.first->second;
+    }
+
+    void Add( const SMDS_MeshElement* elem, int nameID )
+    {
+      if ( !elem || nameID < 1 ) // issue 0021776
+        return;
+      size_t key = groupKey( nameID, elem->GetType() );
+      if ( key >= _elemsByKey.size() )
+        _elemsByKey.resize( groupKey( _names.size(), SMDSAbs_All ));
+      _elemsByKey[ key ].push_back( elem );
+    }
+
+    void Add( const std::vector< const SMDS_MeshElement* >& elems, int nameID )
+    {
+      for ( size_t i = 0; i < elems.size(); ++i )
+        Add( elems[i], nameID );
+    }
+
+    //================================================================================
+    /*!
+     * \brief Add collected elements to groups; create missing groups
+     */
+    //================================================================================
+
+    void Flush( SMESH_Mesh* theMesh )
+    {
+      if ( _elemsByKey.empty() )
+        return;
+
+      // find existing groups of interned names
+      std::vector< SMESHDS_Group* > groupByKey( _elemsByKey.size(), (SMESHDS_Group*) 0 );
+      SMESH_Mesh::GroupIteratorPtr grIt = theMesh->GetGroups();
+      while ( grIt->more() )
+      {
+        SMESH_Group * group = grIt->next();
+        if ( !group ) continue;
+        SMESHDS_Group* groupDS = dynamic_cast< SMESHDS_Group* >( group->GetGroupDS() );
+        if ( !groupDS ) continue;
+        TIDByName::iterator name2id = _idByName.find( group->GetName() );
+        if ( name2id == _idByName.end() ) continue;
+        size_t key = groupKey( name2id->second, groupDS->GetType() );
+        if ( key < groupByKey.size() && !groupByKey[ key ] )
+          groupByKey[ key ] = groupDS;
+      }
+
+      for ( size_t key = 0; key < _elemsByKey.size(); ++key )
+      {
+        std::vector< const SMDS_MeshElement* > & elems = _elemsByKey[ key ];
+        if ( elems.empty() ) continue;
+
+        SMESHDS_Group* groupDS = groupByKey[ key ];
+        if ( !groupDS )
+        {
+          const std::string& name = _names[ key / SMDSAbs_NbElementTypes ];
+          SMESH_Group* group = theMesh->AddGroup( elems[0]->GetType(), name.c_str() );
+          group->SetName( name.c_str() );
+          groupDS = static_cast<SMESHDS_Group*>( group->GetGroupDS() );
+        }
+        SMDS_MeshGroup& smdsGroup = groupDS->SMDSGroup();
+        for ( size_t i = 0; i < elems.size(); ++i )
+          if ( !smdsGroup.Add( elems[i] ))
+            throw SALOME_Exception(LOCALIZED("A given element was not added to a group"));
+
+        SMESHUtils::FreeVector( elems );
+      }
+      _elemsByKey.clear();
+    }
+
+  private:
+
+    static size_t groupKey( size_t nameID, SMDSAbs_ElementType type )
+    {
+      return nameID * SMDSAbs_NbElementTypes + type;
+    }
+
+    typedef std::unordered_map< std::string, int > TIDByName;
 
+    std::vector< std::string >                              _names;
+    TIDByName                                               _idByName;
+    std::vector< std::vector< const SMDS_MeshElement* > >   _elemsByKey;
+  };
+}
 
 //=======================================================================
 //function : updateMeshGroups
@@ -538,12 +712,12 @@ static void removeEmptyGroupsOfDomains(SMESH_Mesh* mesh,
 
 //================================================================================
 /*!
- * \brief Create the groups corresponding to domains
+ * \brief Collect elements of the groups corresponding to domains
  */
 //================================================================================
 
 static void makeDomainGroups( std::vector< std::vector< const SMDS_MeshElement* > >& elemsOfDomain,
-                              SMESH_MesherHelper*                                    theHelper)
+                              TGroupIndex&                                           theGroups)
 {
   // int nbDomains = 0;
   // for ( size_t i = 0; i < elemsOfDomain.size(); ++i )
@@ -555,479 +729,1961 @@ static void makeDomainGroups( std::vector< std::vector< const SMDS_MeshElement*
     std::vector< const SMDS_MeshElement* > & elems = elemsOfDomain[ iDomain ];
     if ( elems.empty() ) continue;
 
-    // find existing groups
-    std::vector< SMESH_Group* > groupOfType( SMDSAbs_NbElementTypes, (SMESH_Group*)NULL );
     const std::string domainName = ( SMESH_Comment( theDomainGroupNamePrefix ) << iDomain );
-    SMESH_Mesh::GroupIteratorPtr groupIt = theHelper->GetMesh()->GetGroups();
-    while ( groupIt->more() )
-    {
-      SMESH_Group* group = groupIt->next();
-      if ( domainName == group->GetName() &&
-           dynamic_cast< SMESHDS_Group* >( group->GetGroupDS()) )
-        groupOfType[ group->GetGroupDS()->GetType() ] = group;
-    }
-    // create and fill the groups
-    size_t iElem = 0;
-    do
-    {
-      SMESH_Group* group = groupOfType[ elems[ iElem ]->GetType() ];
-      if ( !group )
-        group = theHelper->GetMesh()->AddGroup( elems[ iElem ]->GetType(),
-                                                domainName.c_str() );
-      SMDS_MeshGroup& groupDS =
-        static_cast< SMESHDS_Group* >( group->GetGroupDS() )->SMDSGroup();
-
-      while ( iElem < elems.size() && groupDS.Add( elems[iElem] ))
-        ++iElem;
-
-    } while ( iElem < elems.size() );
+    theGroups.Add( elems, theGroups.Intern( domainName ));
+    SMESHUtils::FreeVector( elems );
   }
 }
 
-//=======================================================================
-//function : readGMFFile
-//purpose  : read GMF file w/o geometry associated to mesh
-//=======================================================================
-
-static bool readGMFFile(MG_Tetra_API*                   MGOutput,
-                        const char*                     theFile,
-                        GHS3DPlugin_GHS3D*              theAlgo,
-                        SMESH_MesherHelper*             theHelper,
-                        std::vector <const SMDS_MeshNode*> &    theNodeByGhs3dId,
-                        std::vector <const SMDS_MeshElement*> & theFaceByGhs3dId,
-                        map<const SMDS_MeshNode*,int> & /*theNodeToGhs3dIdMap*/,
-                        std::vector<std::string> &      aNodeGroupByGhs3dId,
-                        std::vector<std::string> &      anEdgeGroupByGhs3dId,
-                        std::vector<std::string> &      aFaceGroupByGhs3dId,
-                        std::set<std::string> &         groupsToRemove,
-                        bool                            toMakeGroupsOfDomains=false,
-                        bool                            toMeshHoles=true)
+namespace
 {
-  std::string tmpStr;
-  SMESHDS_Mesh* theMeshDS = theHelper->GetMeshDS();
-  const bool hasGeom = ( theHelper->GetMesh()->HasShapeToMesh() );
+  //=======================================================================
+  /*!
+   * \brief Connectivity of all elements of one GMF keyword stored in flat
+   *        arrays: nbRef node ids per element one after another, and
+   *        a domain reference per element
+   */
+  //=======================================================================
 
-  int nbInitialNodes = (int) theNodeByGhs3dId.size();
-  
-#ifdef _MY_DEBUG_
-  const bool isQuadMesh = 
-    theHelper->GetMesh()->NbEdges( ORDER_QUADRATIC ) ||
-    theHelper->GetMesh()->NbFaces( ORDER_QUADRATIC ) ||
-    theHelper->GetMesh()->NbVolumes( ORDER_QUADRATIC );
-  std::cout << "theNodeByGhs3dId.size(): " << nbInitialNodes << std::endl;
-  std::cout << "theHelper->GetMesh()->NbNodes(): " << theMeshDS->NbNodes() << std::endl;
-  std::cout << "isQuadMesh: " << isQuadMesh << std::endl;
-#endif
-  
-  // ---------------------------------
-  // Read generated elements and nodes
-  // ---------------------------------
+  struct TGmfConnectivity
+  {
+    int              _nbRef;
+    int              _nbElem;
+    std::vector<int> _nodes;   // _nbElem * _nbRef node ids
+    std::vector<int> _domains; // _nbElem domain references
 
-  int nbElem = 0, nbRef = 0;
-  int aGMFNodeID = 0;
-  std::vector< const SMDS_MeshNode*> GMFNode;
-#ifdef _MY_DEBUG_
-  std::map<int, std::set<int> > subdomainId2tetraId;
-#endif
-  std::map <GmfKwdCod,int> tabRef;
-  const bool force3d = !hasGeom;
-  const int  noID    = 0;
+    TGmfConnectivity(): _nbRef( 0 ), _nbElem( 0 ) {}
 
-  tabRef[GmfVertices]       = 3; // for new nodes and enforced nodes
-  tabRef[GmfCorners]        = 1;
-  tabRef[GmfEdges]          = 2; // for enforced edges
-  tabRef[GmfRidges]         = 1;
-  tabRef[GmfTriangles]      = 3; // for enforced faces
-  tabRef[GmfQuadrilaterals] = 4;
-  tabRef[GmfTetrahedra]     = 4; // for new tetras
-  tabRef[GmfHexahedra]      = 8;
+    void Resize( int nbRef, int nbElem )
+    {
+      _nbRef  = nbRef;
+      _nbElem = nbElem;
+      _nodes.assign  ( size_t( nbElem ) * nbRef, 0 );
+      _domains.assign( nbElem, 0 );
+    }
+    void Clear()
+    {
+      _nbElem = 0;
+      SMESHUtils::FreeVector( _nodes );
+      SMESHUtils::FreeVector( _domains );
+    }
+    int*       Nodes( int iElem )       { return & _nodes[ size_t( iElem ) * _nbRef ]; }
+    const int* Nodes( int iElem ) const { return & _nodes[ size_t( iElem ) * _nbRef ]; }
+    int        Domain( int iElem ) const { return _domains[ iElem ]; }
 
-  int ver, dim;
-  int InpMsh = MGOutput->GmfOpenMesh( theFile, GmfRead, &ver, &dim);
-  if (!InpMsh)
-    return false;
+    //! Check that node ids are in [1,maxNodeID] and domains in [0,maxDomain]
+    bool IsValid( int maxNodeID, int maxDomain ) const
+    {
+      for ( size_t i = 0; i < _nodes.size(); ++i )
+        if ( _nodes[ i ] < 1 || _nodes[ i ] > maxNodeID )
+          return false;
+      for ( size_t i = 0; i < _domains.size(); ++i )
+        if ( _domains[ i ] < 0 || _domains[ i ] > maxDomain )
+          return false;
+      return true;
+    }
+  };
 
-  // Read ids of domains
-  vector< int > solidIDByDomain;
-  if ( hasGeom )
+  //=======================================================================
+  /*!
+   * \brief Sets new volumes and nodes on solids by sub-domains of MG-Tetra output.
+   *
+   * Volumes are collected by sub-domain, and a new node takes the sub-domain
+   * of the first volume using it. Then each sub-mesh of a solid gets its
+   * volumes and nodes in one pass, by Flush() or at the latest at destruction,
+   * so that created elements are on shapes even if reading is interrupted.
+   */
+  //=======================================================================
+
+  class TSubDomainsOnSolids
   {
-    int solid1; // id used in case of 1 domain or some reading failure
-    if ( theHelper->GetSubShape().ShapeType() == TopAbs_SOLID )
-      solid1 = theHelper->GetSubShapeID();
-    else
-      solid1 = theMeshDS->ShapeToIndex
-        ( TopExp_Explorer( theHelper->GetSubShape(), TopAbs_SOLID ).Current() );
+  public:
 
-    int nbDomains = MGOutput->GmfStatKwd( InpMsh, GmfSubDomainFromGeom );
-    if ( nbDomains > 1 )
+    TSubDomainsOnSolids( SMESHDS_Mesh*                              meshDS,
+                         const std::vector< int >&                  solidIDByDomain,
+                         const std::vector< const SMDS_MeshNode* >& nodes )
+      : _meshDS( meshDS ), _solidIDByDomain( solidIDByDomain ), _nodes( nodes ),
+        _volumesOfDomain( solidIDByDomain.size() ),
+        _domainOfNode( solidIDByDomain.empty() ? 0 : nodes.size(), -1 ) {}
+
+    ~TSubDomainsOnSolids() { Flush(); }
+
+    //! Reserve memory for volumes of given domains
+    void Reserve( const TGmfConnectivity& conn )
     {
-      solidIDByDomain.resize( nbDomains+1, theHelper->GetSubShapeID() );
-      int faceNbNodes, faceIndex, orientation, domainNb;
-      MGOutput->GmfGotoKwd( InpMsh, GmfSubDomainFromGeom );
-      for ( int i = 0; i < nbDomains; ++i )
+      std::vector< int > nbVolumesOfDomain( _volumesOfDomain.size(), 0 );
+      for ( int iElem = 0; iElem < conn._nbElem; iElem++ )
+        nbVolumesOfDomain[ conn.Domain( iElem )]++;
+      for ( size_t iDomain = 0; iDomain < nbVolumesOfDomain.size(); ++iDomain )
+        _volumesOfDomain[ iDomain ].reserve( _volumesOfDomain[ iDomain ].size() +
+                                             nbVolumesOfDomain[ iDomain ]);
+    }
+
+    //! Store a volume of a domain and the domain of its new nodes
+    void AddVolume( const SMDS_MeshElement* volume, int iDomain, const int* nodeIDs, int nbNodes )
+    {
+      _volumesOfDomain[ iDomain ].push_back( volume );
+      for ( int iN = 0; iN < nbNodes; ++iN )
+        if ( nodeIDs[ iN ] > 0 && _domainOfNode[ nodeIDs[ iN ]] < 0 )
+          _domainOfNode[ nodeIDs[ iN ]] = iDomain;
+    }
+
+    //! Add stored volumes and nodes to sub-meshes of solids
+    void Flush()
+    {
+      std::vector< SMESHDS_SubMesh* > subMeshOfDomain( _volumesOfDomain.size(), 0 );
+      for ( size_t iDomain = 0; iDomain < _volumesOfDomain.size(); ++iDomain )
       {
-        faceIndex = 0;
-        MGOutput->GmfGetLin( InpMsh, GmfSubDomainFromGeom,
-                   &faceNbNodes, &faceIndex, &orientation, &domainNb, i);
-        solidIDByDomain[ domainNb ] = 1;
-        if ( 0 < faceIndex && faceIndex-1 < (int)theFaceByGhs3dId.size() )
+        std::vector< const SMDS_MeshElement* >& volumes = _volumesOfDomain[ iDomain ];
+        if ( volumes.empty() )
+          continue;
+        SMESHDS_SubMesh* sm = _meshDS->NewSubMesh( _solidIDByDomain[ iDomain ]);
+        for ( size_t i = 0; i < volumes.size(); ++i )
+          sm->AddElement( volumes[ i ]);
+        SMESHUtils::FreeVector( volumes );
+        subMeshOfDomain[ iDomain ] = sm;
+      }
+      for ( size_t i = 1; i < _domainOfNode.size(); ++i )
+      {
+        const SMDS_MeshNode* node = _nodes[ i ];
+        if ( _domainOfNode[ i ] < 0 || !node || node->getshapeId() > 0 )
+          continue;
+        if ( SMESHDS_SubMesh* sm = subMeshOfDomain[ _domainOfNode[ i ]])
         {
-          const SMDS_MeshElement* face = theFaceByGhs3dId[ faceIndex-1 ];
-          const SMDS_MeshNode* nn[3] = { face->GetNode(0),
-                                         face->GetNode(1),
-                                         face->GetNode(2) };
-          if ( orientation < 0 )
-            std::swap( nn[1], nn[2] );
-          solidIDByDomain[ domainNb ] =
-            findShapeID( *theHelper->GetMesh(), nn[0], nn[1], nn[2], toMeshHoles );
-          if ( solidIDByDomain[ domainNb ] > 0 )
-          {
-#ifdef _MY_DEBUG_
-            std::cout << "solid " << solidIDByDomain[ domainNb ] << std::endl;
-#endif
-            const TopoDS_Shape& foundShape = theMeshDS->IndexToShape( solidIDByDomain[ domainNb ] );
-            if ( ! theHelper->IsSubShape( foundShape, theHelper->GetSubShape() ))
-              solidIDByDomain[ domainNb ] = HOLE_ID;
-          }
+          sm->AddNode( node ); // as SMESHDS_Mesh::SetNodeInVolume() does
+          const_cast< SMDS_MeshNode* >( node )->SetPosition( SMDS_SpacePosition::originSpacePosition() );
         }
       }
+      SMESHUtils::FreeVector( _domainOfNode );
     }
-    if ( solidIDByDomain.size() < 2 )
-      solidIDByDomain.resize( 2, solid1 );
-  }
 
-  // Issue 0020682. Avoid creating nodes and tetras at place where
-  // volumic elements already exist
-  SMESH_ElementSearcher* elemSearcher = 0;
-  std::vector< const SMDS_MeshElement* > foundVolumes;
-  if ( !hasGeom && theHelper->GetMesh()->NbVolumes() > 0 )
-    elemSearcher = SMESH_MeshAlgos::GetElementSearcher( *theMeshDS );
-  unique_ptr< SMESH_ElementSearcher > elemSearcherDeleter( elemSearcher );
+  private:
 
-  // IMP 0022172: [CEA 790] create the groups corresponding to domains
-  std::vector< std::vector< const SMDS_MeshElement* > > elemsOfDomain;
+    SMESHDS_Mesh*                                         _meshDS;
+    const std::vector< int >&                             _solidIDByDomain;
+    const std::vector< const SMDS_MeshNode* >&            _nodes;
+    std::vector< std::vector< const SMDS_MeshElement* > > _volumesOfDomain;
+    std::vector< int >                                    _domainOfNode; // by MG-Tetra node ID
+  };
 
-  int nbVertices = MGOutput->GmfStatKwd( InpMsh, GmfVertices ) - nbInitialNodes;
-  if ( nbVertices < 0 )
-    return false;
-  GMFNode.resize( nbVertices + 1 );
+  //=======================================================================
+  /*!
+   * \brief Return number of SMESH_ElementSearcher's to use in parallel. Each
+   *        searcher builds own trees of nbTreeElems elements, so the number
+   *        is reduced for big meshes not to take too much memory.
+   */
+  //=======================================================================
 
-  std::map <GmfKwdCod,int>::const_iterator it = tabRef.begin();
-  for ( ; it != tabRef.end() ; ++it)
+  int nbParallelSearchers( size_t nbTreeElems )
   {
-    if(theAlgo->computeCanceled()) {
-      return false;
-    }
-    int dummy, solidID;
-    GmfKwdCod token = it->first;
-    nbRef           = it->second;
-
-    nbElem = MGOutput->GmfStatKwd( InpMsh, token);
-    if (nbElem > 0) {
-      MGOutput->GmfGotoKwd( InpMsh, token);
-      std::cout << "Read " << nbElem;
-    }
-    else
-      continue;
+    const size_t maxTreeElems = 10000000; // elements in trees of all searchers
+    const size_t nbThreads    = std::min( 8, std::max( 1, OSD_Parallel::NbLogicalProcessors() ));
+    return (int) std::max( size_t( 1 ),
+                           std::min( nbThreads, maxTreeElems / std::max( size_t( 1 ), nbTreeElems )));
+  }
 
-    // Store connectivity in vector of vectors
-    // For each element id, store its nodes
-    // This allows to prevent the int64 limit of connectivity size without using smIdType
-    // because GmfGetLin only allows int
-    std::vector< std::vector<int> > id (nbElem, std::vector<int>(tabRef[token])); // node ids
+  //=======================================================================
+  /*!
+   * \brief Finds points lying inside volumes that exist in the mesh before
+   *        MG-Tetra result is read (issue 0020682).
+   *
+   * Points out of the bounding box of the volumes are rejected at once; the rest
+   * are checked in parallel, each thread using its own SMESH_ElementSearcher;
+   * the number of searchers is limited by the mesh size. Trees of the
+   * searchers are built at construction, so volumes added later are not found.
+   */
+  //=======================================================================
 
-    std::vector<int> domainID( nbElem ); // domain
+  class TExistingVolumes
+  {
+  public:
+
+    TExistingVolumes( SMESHDS_Mesh* mesh ): _mesh( mesh )
+    {
+      SMDS_ElemIteratorPtr volIt = mesh->elementsIterator( SMDSAbs_Volume );
+      while ( volIt->more() )
+      {
+        const SMDS_MeshElement* vol = volIt->next();
+        for ( int iN = 0, nbN = vol->NbCornerNodes(); iN < nbN; ++iN )
+          _box.Add( SMESH_TNodeXYZ( vol->GetNode( iN )));
+      }
+      if ( _box.IsVoid() )
+        return;
+      _box.Enlarge( 1e-7 * std::sqrt( _box.SquareExtent() ) + Precision::Confusion() );
+
+      _searchers.resize( nbParallelSearchers( mesh->NbVolumes() ));
+      OSD_Parallel::For( 0, int( _searchers.size() ), TInit( *this ));
+    }
+
+    ~TExistingVolumes()
+    {
+      for ( size_t i = 0; i < _searchers.size(); ++i )
+        delete _searchers[i];
+    }
+
+    //================================================================================
+    /*!
+     * \brief Set isInside[i] to 1 if points[i] is inside a volume; skip points
+     *        whose isInside[i] is already set
+     */
+    //================================================================================
+
+    void FindPointsInVolumes( const std::vector< gp_XYZ >& points,
+                              std::vector< char >&         isInside )
+    {
+      if ( _searchers.empty() )
+        return;
+
+      std::vector< int > toCheck;
+      for ( size_t i = 0; i < points.size(); ++i )
+        if ( !isInside[i] && !_box.IsOut( points[i] ))
+          toCheck.push_back( int( i ));
+      if ( toCheck.empty() )
+        return;
+
+      TFind find( *this, points, toCheck, isInside );
+      OSD_Parallel::For( 0, int( _searchers.size() ), find, toCheck.size() < 100 );
+    }
+
+  private:
+
+    struct TInit // build a tree of a searcher
+    {
+      TExistingVolumes& _vols;
+      TInit( TExistingVolumes& vols ): _vols( vols ) {}
+      void operator()( int iThread ) const
+      {
+        std::vector< const SMDS_MeshElement* > found;
+        _vols._searchers[ iThread ] = SMESH_MeshAlgos::GetElementSearcher( *_vols._mesh );
+        _vols._searchers[ iThread ]->FindElementsByPoint( gp_Pnt( _vols._box.CornerMin() ), SMDSAbs_Volume, found );
+      }
+    };
+
+    struct TFind // check a chunk of points
+    {
+      TExistingVolumes&            _vols;
+      const std::vector< gp_XYZ >& _points;
+      const std::vector< int >&    _toCheck;
+      std::vector< char >&         _isInside;
+
+      TFind( TExistingVolumes& vols, const std::vector< gp_XYZ >& points,
+             const std::vector< int >& toCheck, std::vector< char >& isInside )
+        : _vols( vols ), _points( points ), _toCheck( toCheck ), _isInside( isInside ) {}
+
+      void operator()( int iThread ) const
+      {
+        const size_t nbThreads = _vols._searchers.size();
+        const size_t chunkSize = ( _toCheck.size() + nbThreads - 1 ) / nbThreads;
+        const size_t iBeg = iThread * chunkSize;
+        const size_t iEnd = std::min( iBeg + chunkSize, _toCheck.size() );
+
+        SMESH_ElementSearcher* searcher = _vols._searchers[ iThread ];
+        std::vector< const SMDS_MeshElement* > found;
+        for ( size_t i = iBeg; i < iEnd; ++i )
+        {
+          const int iP = _toCheck[ i ];
+          _isInside[ iP ] = ( searcher->FindElementsByPoint( gp_Pnt( _points[ iP ] ), SMDSAbs_Volume, found ) > 0 );
+        }
+      }
+    };
+
+    SMESHDS_Mesh*                         _mesh;
+    Bnd_B3d                               _box;
+    std::vector< SMESH_ElementSearcher* > _searchers; // one per thread
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Read connectivity of all elements of a keyword
+   *  \return bool - false if the elements can't be read
+   */
+  //=======================================================================
+
+  bool readConnectivity( MG_Tetra_API*     MGOutput,
+                         int               InpMsh,
+                         GmfKwdCod         token,
+                         int               nbRef,
+                         int               nbElem,
+                         TGmfConnectivity& conn )
+  {
+    conn.Resize( nbRef, nbElem );
+    if ( nbElem < 1 )
+      return true;
+    const bool hasDomain = ( nbRef > 1 ); // corners and ridges have no domain
+    return MGOutput->GmfGetBlock( InpMsh, token, conn.Nodes( 0 ),
+                                  hasDomain ? & conn._domains[0] : 0, nbRef, nbElem );
+  }
+
+  //=======================================================================
+  /*!
+   * \brief Reader of an MG-Tetra output mesh working in a separate thread.
+   *
+   * Coordinates of vertices are read by blocks and connectivity of elements
+   * by keywords. Read chunks are passed through a bounded queue to the thread
+   * creating SMESH nodes and elements, so that reading and creation overlap.
+   * The mesh is closed as soon as the last keyword is read, so that MG-Tetra
+   * library frees the resulting mesh before the last elements are created.
+   * MGOutput must not be used by other threads until Stop() returns.
+   * An exception thrown by the reader thread is rethrown by Pop() or Stop().
+   * Reading stops at data that can't be read, then Pop() returns false.
+   */
+  //=======================================================================
+
+  class TGmfPipelineReader
+  {
+  public:
+
+    struct TKeyword
+    {
+      GmfKwdCod _token;
+      int       _nbRef;
+      int       _nbElem;
+      bool      _isRead; // connectivity is already read by the caller
+    };
+
+    struct TChunk
+    {
+      int                   _nbVertices; // nb vertices in a block
+      std::vector< double > _xyz;        // coordinates of a block of vertices
+      TGmfConnectivity      _conn;       // connectivity of all elements of a keyword
+
+      TChunk(): _nbVertices( 0 ) {}
+    };
+
+    static const int theVertexBlockSize = 65536;
+
+    TGmfPipelineReader( MG_Tetra_API*                  MGOutput,
+                        int                            InpMsh,
+                        const std::vector< TKeyword >& keywords,
+                        size_t                         capacity = 4 )
+      : _mg( MGOutput ), _inpMsh( InpMsh ), _keywords( keywords ), _capacity( capacity ),
+        _isDone( false ), _toStop( false ), _isClosed( false )
+    {
+      _thread = std::thread( &TGmfPipelineReader::run, this );
+    }
+
+    ~TGmfPipelineReader() { join(); }
+
+    //! Wait for the next chunk. Return false if the reader stopped before reading it
+    bool Pop( TChunk& chunk )
+    {
+      std::unique_lock< std::mutex > lock( _mutex );
+      while ( _queue.empty() && !_isDone )
+        _notEmpty.wait( lock );
+      if ( _queue.empty() )
+      {
+        std::exception_ptr error;
+        std::swap( error, _error );
+        if ( error )
+          std::rethrow_exception( error );
+        return false;
+      }
+      std::swap( chunk, _queue.front() );
+      _queue.pop_front();
+      _notFull.notify_one();
+      return true;
+    }
+
+    //! Stop reading and wait for the reader thread. Return true if the mesh is closed
+    bool Stop()
+    {
+      join();
+      std::exception_ptr error;
+      std::swap( error, _error );
+      if ( error )
+        std::rethrow_exception( error );
+      return _isClosed;
+    }
+
+  private:
+
+    void join()
+    {
+      if ( _thread.joinable() )
+      {
+        {
+          std::lock_guard< std::mutex > lock( _mutex );
+          _toStop = true;
+        }
+        _notFull.notify_all();
+        _thread.join();
+      }
+    }
+
+    void run()
+    {
+      std::exception_ptr error;
+      try
+      {
+        read();
+      }
+      catch (...)
+      {
+        error = std::current_exception(); // passed to the consumer by Pop() or Stop()
+      }
+      std::lock_guard< std::mutex > lock( _mutex );
+      _error  = error;
+      _isDone = true;
+      _notEmpty.notify_all();
+    }
+
+    void read()
+    {
+      for ( size_t iK = 0; iK < _keywords.size(); ++iK )
+      {
+        const TKeyword& kw = _keywords[ iK ];
+        const bool   isLast = ( iK + 1 == _keywords.size() );
+        if ( kw._isRead )
+        {
+          if ( isLast )
+            close();
+          continue;
+        }
+        _mg->GmfGotoKwd( _inpMsh, kw._token );
+        if ( kw._token == GmfVertices )
+        {
+          const int blockSize = theVertexBlockSize;
+          for ( int iBlock = 0; iBlock < kw._nbElem; iBlock += blockSize )
+          {
+            TChunk chunk;
+            chunk._nbVertices = std::min( blockSize, kw._nbElem - iBlock );
+            chunk._xyz.resize( 3 * chunk._nbVertices );
+            if ( !_mg->GmfGetBlock( _inpMsh, kw._token, &chunk._xyz[0], chunk._nbVertices ))
+              return;
+            if ( isLast && iBlock + blockSize >= kw._nbElem )
+              close();
+            if ( !push( chunk ))
+              return;
+          }
+        }
+        else
+        {
+          TChunk chunk;
+          if ( !readConnectivity( _mg, _inpMsh, kw._token, kw._nbRef, kw._nbElem, chunk._conn ))
+            return;
+          if ( isLast )
+            close();
+          if ( !push( chunk ))
+            return;
+        }
+      }
+    }
+
+    bool push( TChunk& chunk )
+    {
+      std::unique_lock< std::mutex > lock( _mutex );
+      while ( _queue.size() >= _capacity && !_toStop )
+        _notFull.wait( lock );
+      if ( _toStop )
+        return false;
+      _queue.push_back( TChunk() );
+      std::swap( _queue.back(), chunk );
+      _notEmpty.notify_one();
+      return true;
+    }
+
+    void close()
+    {
+      _mg->GmfCloseMesh( _inpMsh );
+      _isClosed = true;
+    }
+
+    MG_Tetra_API*           _mg;
+    int                     _inpMsh;
+    std::vector< TKeyword > _keywords;
+    size_t                  _capacity; // max nb of chunks in _queue
+    std::deque< TChunk >    _queue;
+    bool                    _isDone;   // reader thread finished
+    bool                    _toStop;   // consumer stopped reading
+    bool                    _isClosed; // the mesh is closed by the reader thread
+    std::exception_ptr      _error;    // exception thrown by the reader thread
+    std::mutex              _mutex;
+    std::condition_variable _notEmpty, _notFull;
+    std::thread             _thread;
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Return index of a point on a 3D Hilbert curve of 2^21 cells per
+   *        axis. Point coordinates are given in cells.
+   *
+   * The point is transformed to the "transposed" Hilbert index by J.Skilling's
+   * algorithm ("Programming the Hilbert curve", AIP Conf. Proc. 707, 2004),
+   * whose bits are then interleaved.
+   */
+  //=======================================================================
+
+  unsigned long long hilbertIndex( unsigned int x, unsigned int y, unsigned int z )
+  {
+    const int          nbBits = 21;
+    const unsigned int topBit = 1u << ( nbBits - 1 );
+    unsigned int X[3] = { x, y, z };
+
+    // inverse undo of excess work
+    for ( unsigned int q = topBit; q > 1; q >>= 1 )
+    {
+      const unsigned int p = q - 1;
+      for ( int i = 0; i < 3; ++i )
+        if ( X[i] & q )
+        {
+          X[0] ^= p; // invert
+        }
+        else
+        {
+          const unsigned int t = ( X[0] ^ X[i] ) & p; // exchange
+          X[0] ^= t;
+          X[i] ^= t;
+        }
+    }
+    // Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    unsigned int t = 0;
+    for ( unsigned int q = topBit; q > 1; q >>= 1 )
+      if ( X[2] & q )
+        t ^= q - 1;
+    for ( int i = 0; i < 3; ++i )
+      X[i] ^= t;
+
+    unsigned long long index = 0;
+    for ( int b = nbBits - 1; b >= 0; --b )
+      for ( int i = 0; i < 3; ++i )
+        index = ( index << 1 ) | (( X[i] >> b ) & 1u );
+    return index;
+  }
+
+  //=======================================================================
+  /*!
+   * \brief Functor computing Hilbert indices of points
+   */
+  //=======================================================================
+
+  struct THilbertIndexer
+  {
+    const std::vector< gp_XYZ >&                          _points;
+    std::vector< std::pair< unsigned long long, int > >&  _indexAndPoint;
+    gp_XYZ                                                _min;
+    double                                                _scale; // cells per unit length
+
+    THilbertIndexer( const std::vector< gp_XYZ >&                         points,
+                     std::vector< std::pair< unsigned long long, int > >& indexAndPoint,
+                     const gp_XYZ&                                        minXYZ,
+                     double                                               scale )
+      : _points( points ), _indexAndPoint( indexAndPoint ), _min( minXYZ ), _scale( scale ) {}
+
+    void operator()( const int iPoint ) const
+    {
+      const gp_XYZ cell = ( _points[ iPoint ] - _min ) * _scale;
+      _indexAndPoint[ iPoint ] =
+        std::make_pair( hilbertIndex( (unsigned int) cell.X(),
+                                      (unsigned int) cell.Y(),
+                                      (unsigned int) cell.Z() ), iPoint );
+    }
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Return indices of points in the order of a Hilbert curve
+   *        passing through their bounding box. Points of equal cells keep
+   *        their relative order.
+   */
+  //=======================================================================
+
+  void sortByHilbertCurve( const std::vector< gp_XYZ >& points,
+                           std::vector< int > &         order )
+  {
+    order.clear();
+    if ( points.empty() )
+      return;
+
+    gp_XYZ minXYZ = points[0], maxXYZ = points[0];
+    for ( size_t i = 1; i < points.size(); ++i )
+    {
+      minXYZ.SetX( std::min( minXYZ.X(), points[i].X() ));
+      minXYZ.SetY( std::min( minXYZ.Y(), points[i].Y() ));
+      minXYZ.SetZ( std::min( minXYZ.Z(), points[i].Z() ));
+      maxXYZ.SetX( std::max( maxXYZ.X(), points[i].X() ));
+      maxXYZ.SetY( std::max( maxXYZ.Y(), points[i].Y() ));
+      maxXYZ.SetZ( std::max( maxXYZ.Z(), points[i].Z() ));
+    }
+    const gp_XYZ size    = maxXYZ - minXYZ;
+    const double maxSize = std::max( size.X(), std::max( size.Y(), size.Z() ));
+    const double nbCells = double( 1 << 21 ) - 1;
+    const double scale   = maxSize > 0. ? nbCells / maxSize : 0.;
+
+    std::vector< std::pair< unsigned long long, int > > indexAndPoint( points.size() );
+    OSD_Parallel::For( 0, (int) points.size(),
+                       THilbertIndexer( points, indexAndPoint, minXYZ, scale ),
+                       /*isForceSingleThreadExecution=*/points.size() < 10000 );
+    std::sort( indexAndPoint.begin(), indexAndPoint.end() );
+
+    order.resize( points.size() );
+    for ( size_t i = 0; i < indexAndPoint.size(); ++i )
+      order[ i ] = indexAndPoint[ i ].second;
+  }
+}
+
+//=======================================================================
+//function : readGMFFile
+//purpose  : read GMF file w/o geometry associated to mesh
+//=======================================================================
+
+static bool readGMFFile(MG_Tetra_API*                   MGOutput,
+                        const char*                     theFile,
+                        GHS3DPlugin_GHS3D*              theAlgo,
+                        SMESH_MesherHelper*             theHelper,
+                        std::vector <const SMDS_MeshNode*> &    theNodeByGhs3dId,
+                        std::vector <const SMDS_MeshElement*> & theFaceByGhs3dId,
+                        std::vector<int> &              aNodeGroupByGhs3dId,
+                        std::vector<int> &              anEdgeGroupByGhs3dId,
+                        std::vector<int> &              aFaceGroupByGhs3dId,
+                        TGroupIndex &                   theGroups,
+                        std::string &                   theErrStr,
+                        bool                            toMakeGroupsOfDomains=false,
+                        bool                            toMeshHoles=true,
+                        bool                            toRenumber=false)
+{
+  std::string tmpStr;
+  SMESHDS_Mesh* theMeshDS = theHelper->GetMeshDS();
+  const std::string badFileErr = SMESH_Comment("Can't read the MG-Tetra result file ") << theFile;
+  const bool hasGeom = ( theHelper->GetMesh()->HasShapeToMesh() );
+
+  int nbInitialNodes = (int) theNodeByGhs3dId.size();
+  
+#ifdef _MY_DEBUG_
+  const bool isQuadMesh = 
+    theHelper->GetMesh()->NbEdges( ORDER_QUADRATIC ) ||
+    theHelper->GetMesh()->NbFaces( ORDER_QUADRATIC ) ||
+    theHelper->GetMesh()->NbVolumes( ORDER_QUADRATIC );
+  std::cout << "theNodeByGhs3dId.size(): " << nbInitialNodes << std::endl;
+  std::cout << "theHelper->GetMesh()->NbNodes(): " << theMeshDS->NbNodes() << std::endl;
+  std::cout << "isQuadMesh: " << isQuadMesh << std::endl;
+#endif
+  
+  // ---------------------------------
+  // Read generated elements and nodes
+  // ---------------------------------
+
+  int nbElem = 0, nbRef = 0;
+  int aGMFNodeID = 0;
+  std::vector< const SMDS_MeshNode*> GMFNode;
+#ifdef _MY_DEBUG_
+  std::map<int, std::set<int> > subdomainId2tetraId;
+#endif
+  std::map <GmfKwdCod,int> tabRef;
+  TGmfConnectivity         conn; // node ids and domains of elements of one token
+  const bool force3d = !hasGeom;
+  const int  noID    = 0;
+
+  tabRef[GmfVertices]       = 3; // for new nodes and enforced nodes
+  tabRef[GmfCorners]        = 1;
+  tabRef[GmfEdges]          = 2; // for enforced edges
+  tabRef[GmfRidges]         = 1;
+  tabRef[GmfTriangles]      = 3; // for enforced faces
+  tabRef[GmfQuadrilaterals] = 4;
+  tabRef[GmfTetrahedra]     = 4; // for new tetras
+  tabRef[GmfHexahedra]      = 8;
+
+  int ver, dim;
+  int InpMsh = MGOutput->GmfOpenMesh( theFile, GmfRead, &ver, &dim);
+  if (!InpMsh)
+    return false;
+
+  // Read ids of domains
+  vector< int > solidIDByDomain;
+  if ( hasGeom )
+  {
+    int solid1; // id used in case of 1 domain or some reading failure
+    if ( theHelper->GetSubShape().ShapeType() == TopAbs_SOLID )
+      solid1 = theHelper->GetSubShapeID();
+    else
+      solid1 = theMeshDS->ShapeToIndex
+        ( TopExp_Explorer( theHelper->GetSubShape(), TopAbs_SOLID ).Current() );
+
+    int nbDomains = MGOutput->GmfStatKwd( InpMsh, GmfSubDomainFromGeom );
+    if ( nbDomains > 1 )
+    {
+      solidIDByDomain.resize( nbDomains+1, theHelper->GetSubShapeID() );
+      TFaceAncestry faceAncestry( *theHelper->GetMesh(), toMeshHoles );
+      int faceNbNodes, faceIndex, orientation, domainNb;
+      MGOutput->GmfGotoKwd( InpMsh, GmfSubDomainFromGeom );
+      for ( int i = 0; i < nbDomains; ++i )
+      {
+        faceIndex = 0;
+        if ( !MGOutput->GmfGetLin( InpMsh, GmfSubDomainFromGeom,
+                                   &faceNbNodes, &faceIndex, &orientation, &domainNb, i ) ||
+             domainNb < 0 || domainNb > nbDomains )
+        {
+          theErrStr = badFileErr;
+          return false;
+        }
+        solidIDByDomain[ domainNb ] = 1;
+        if ( 0 < faceIndex && faceIndex-1 < (int)theFaceByGhs3dId.size() )
+        {
+          const SMDS_MeshElement* face = theFaceByGhs3dId[ faceIndex-1 ];
+          const SMDS_MeshNode* nn[3] = { face->GetNode(0),
+                                         face->GetNode(1),
+                                         face->GetNode(2) };
+          if ( orientation < 0 )
+            std::swap( nn[1], nn[2] );
+          solidIDByDomain[ domainNb ] =
+            findShapeID( faceAncestry, nn[0], nn[1], nn[2] );
+          if ( solidIDByDomain[ domainNb ] > 0 )
+          {
+#ifdef _MY_DEBUG_
+            std::cout << "solid " << solidIDByDomain[ domainNb ] << std::endl;
+#endif
+            const TopoDS_Shape& foundShape = theMeshDS->IndexToShape( solidIDByDomain[ domainNb ] );
+            if ( ! theHelper->IsSubShape( foundShape, theHelper->GetSubShape() ))
+              solidIDByDomain[ domainNb ] = HOLE_ID;
+          }
+        }
+      }
+    }
+    if ( solidIDByDomain.size() < 2 )
+      solidIDByDomain.resize( 2, solid1 );
+  }
+
+  // Issue 0020682. Avoid creating nodes and tetras at place where
+  // volumic elements already exist
+  TExistingVolumes* existingVolumes = 0;
+  if ( !hasGeom && theHelper->GetMesh()->NbVolumes() > 0 )
+    existingVolumes = new TExistingVolumes( theMeshDS );
+  unique_ptr< TExistingVolumes > existingVolumesDeleter( existingVolumes );
+  std::vector< gp_XYZ > pointsToCheck;
+  std::vector< char >   isInExistingVolume; // or skipped
+
+  // IMP 0022172: [CEA 790] create the groups corresponding to domains
+  std::vector< std::vector< const SMDS_MeshElement* > > elemsOfDomain;
+
+  int nbVertices = MGOutput->GmfStatKwd( InpMsh, GmfVertices ) - nbInitialNodes;
+  if ( nbVertices < 0 )
+  {
+    theErrStr = badFileErr;
+    return false;
+  }
+  GMFNode.resize( nbVertices + 1 );
+
+  // new volumes and nodes are set on solids by sub-domains after creation of volumes
+  TSubDomainsOnSolids subDomainsOnSolids( theMeshDS, solidIDByDomain, GMFNode );
+
+  // if there are holes, read elements before vertices to find out vertices
+  // used by elements out of holes; vertices in holes are not created
+  std::map< GmfKwdCod, TGmfConnectivity > preReadConn;
+  std::vector< bool > isNodeUsed;
+  const int anyDomain = std::numeric_limits< int >::max(); // domains of edges and faces are not used
+  if ( hasGeom &&
+       std::find( solidIDByDomain.begin(), solidIDByDomain.end(), HOLE_ID ) != solidIDByDomain.end() )
+  {
+    isNodeUsed.resize( nbVertices + 1, false );
+    const GmfKwdCod elemTokens[] = { GmfEdges, GmfTriangles, GmfQuadrilaterals,
+                                     GmfTetrahedra, GmfHexahedra };
+    for ( size_t iT = 0; iT < sizeof( elemTokens ) / sizeof( GmfKwdCod ); ++iT )
+    {
+      const GmfKwdCod token = elemTokens[ iT ];
+      const int nbE = MGOutput->GmfStatKwd( InpMsh, token );
+      if ( nbE < 1 )
+        continue;
+      TGmfConnectivity& c = preReadConn[ token ];
+      MGOutput->GmfGotoKwd( InpMsh, token );
+      const bool isVolume = ( token == GmfTetrahedra || token == GmfHexahedra );
+      const int maxDomain = isVolume ? int( solidIDByDomain.size() ) - 1 : anyDomain;
+      if ( !readConnectivity( MGOutput, InpMsh, token, tabRef[ token ], nbE, c ) ||
+           !c.IsValid( nbInitialNodes + nbVertices, maxDomain ))
+      {
+        theErrStr = badFileErr;
+        return false;
+      }
+      for ( int iElem = 0; iElem < nbE; iElem++ )
+      {
+        if ( isVolume && solidIDByDomain[ c.Domain( iElem )] == HOLE_ID )
+          continue;
+        const int* elemNodeIDs = c.Nodes( iElem );
+        for ( int iRef = 0; iRef < c._nbRef; iRef++ )
+          if ( elemNodeIDs[ iRef ] > nbInitialNodes )
+            isNodeUsed[ elemNodeIDs[ iRef ] - nbInitialNodes ] = true;
+      }
+    }
+  }
+
+  // keywords to read; corners and ridges are not used
+  std::vector< TGmfPipelineReader::TKeyword > keywords;
+  std::map <GmfKwdCod,int>::const_iterator it = tabRef.begin();
+  for ( ; it != tabRef.end() ; ++it)
+  {
+    if ( it->first == GmfCorners || it->first == GmfRidges )
+      continue;
+    TGmfPipelineReader::TKeyword keyword;
+    keyword._token  = it->first;
+    keyword._nbRef  = it->second;
+    keyword._nbElem = MGOutput->GmfStatKwd( InpMsh, it->first );
+    keyword._isRead = ( preReadConn.count( it->first ) > 0 );
+    if ( keyword._nbElem > 0 )
+      keywords.push_back( keyword );
+  }
+
+  // read the mesh in a separate thread while creating elements from read chunks;
+  // MGOutput is not used by this thread until reader.Stop()
+  TGmfPipelineReader         reader( MGOutput, InpMsh, keywords );
+  TGmfPipelineReader::TChunk chunk;
+
+  for ( size_t iK = 0; iK < keywords.size(); ++iK )
+  {
+    if(theAlgo->computeCanceled()) {
+      return false;
+    }
+    int solidID;
+    GmfKwdCod token = keywords[ iK ]._token;
+    nbRef           = keywords[ iK ]._nbRef;
+    nbElem          = keywords[ iK ]._nbElem;
+    std::cout << "Read " << nbElem;
 
     if (token == GmfVertices) {
       (nbElem <= 1) ? tmpStr = " vertex" : tmpStr = " vertices";
 //       std::cout << nbInitialNodes << " from input mesh " << std::endl;
 
-      // Remove orphan nodes from previous enforced mesh which was cleared
-//       if ( nbElem < nbMeshNodes ) {
-//         const SMDS_MeshNode* node;
-//         SMDS_NodeIteratorPtr nodeIt = theMeshDS->nodesIterator();
-//         while ( nodeIt->more() )
-//         {
-//           node = nodeIt->next();
-//           if (theNodeToGhs3dIdMap.find(node) != theNodeToGhs3dIdMap.end())
-//             theMeshDS->RemoveNode(node);
-//         }
-//       }
+      // Remove orphan nodes from previous enforced mesh which was cleared
+//       if ( nbElem < nbMeshNodes ) {
+//         const SMDS_MeshNode* node;
+//         SMDS_NodeIteratorPtr nodeIt = theMeshDS->nodesIterator();
+//         while ( nodeIt->more() )
+//         {
+//           node = nodeIt->next();
+//           if (theNodeToGhs3dIdMap.find(node) != theNodeToGhs3dIdMap.end())
+//             theMeshDS->RemoveNode(node);
+//         }
+//       }
+
+      
+      int aGMFID;
+      const SMDS_MeshNode * aGMFNode;
+
+      // if toRenumber, nodes are created after reading all vertices, in the order
+      // of a Hilbert curve, so that IDs of nodes close in space are close
+      std::vector< gp_XYZ > newNodesXYZ;
+      std::vector< char >   toCreateNode;
+      if ( toRenumber )
+      {
+        newNodesXYZ.reserve ( nbVertices );
+        toCreateNode.reserve( nbVertices );
+      }
+
+      // coordinates come by blocks
+      const int blockSize = TGmfPipelineReader::theVertexBlockSize;
+      const std::vector< double >& xyz = chunk._xyz;
+
+      for ( int iBlock = 0; iBlock < nbElem; iBlock += blockSize )
+      {
+        if(theAlgo->computeCanceled()) {
+          return false;
+        }
+        const int nbInBlock = std::min( blockSize, nbElem - iBlock );
+        if ( !reader.Pop( chunk ) || chunk._nbVertices != nbInBlock )
+        {
+          theErrStr = badFileErr;
+          return false;
+        }
+
+        if ( existingVolumes ) // check all points of the block at once
+        {
+          pointsToCheck.resize( nbInBlock );
+          for ( int i = 0; i < nbInBlock; ++i )
+            pointsToCheck[i].SetCoord( xyz[3*i], xyz[3*i+1], xyz[3*i+2] );
+          isInExistingVolume.assign( nbInBlock, 0 );
+          existingVolumes->FindPointsInVolumes( pointsToCheck, isInExistingVolume );
+        }
+
+        for ( int iElem = std::max( iBlock, nbInitialNodes ); iElem < iBlock + nbInBlock; iElem++ )
+        {
+          const double* coo = & xyz[ 3 * ( iElem - iBlock )];
+          bool toCreate = true;
+          if ( !isNodeUsed.empty() && !isNodeUsed[ iElem - nbInitialNodes + 1 ])
+            toCreate = false; // in a hole
+          else if ( existingVolumes && isInExistingVolume[ iElem - iBlock ])
+            toCreate = false;
+
+          if ( toRenumber )
+          {
+            newNodesXYZ.push_back( gp_XYZ( coo[0], coo[1], coo[2] ));
+            toCreateNode.push_back( toCreate );
+            continue;
+          }
+          aGMFNode = toCreate ? theHelper->AddNode( coo[0], coo[1], coo[2] ) : 0;
+
+          aGMFID = iElem -nbInitialNodes +1;
+          GMFNode[ aGMFID ] = aGMFNode;
+          if (aGMFID-1 < (int)aNodeGroupByGhs3dId.size())
+            theGroups.Add( aGMFNode, aNodeGroupByGhs3dId[aGMFID-1] );
+        }
+      }
+
+      if ( toRenumber )
+      {
+        std::vector< int > order;
+        sortByHilbertCurve( newNodesXYZ, order );
+        for ( size_t i = 0; i < order.size(); ++i )
+        {
+          const gp_XYZ& coo = newNodesXYZ[ order[ i ]];
+          aGMFNode = toCreateNode[ order[ i ]] ? theHelper->AddNode( coo.X(), coo.Y(), coo.Z() ) : 0;
+
+          aGMFID = order[ i ] + 1;
+          GMFNode[ aGMFID ] = aGMFNode;
+          if (aGMFID-1 < (int)aNodeGroupByGhs3dId.size())
+            theGroups.Add( aGMFNode, aNodeGroupByGhs3dId[aGMFID-1] );
+        }
+      }
+    }
+    else {
+      switch ( token ) {
+      case GmfCorners:        tmpStr = ( nbElem <= 1 ) ? " corner"        : " corners";        break;
+      case GmfRidges:         tmpStr = ( nbElem <= 1 ) ? " ridge"         : " ridges";         break;
+      case GmfEdges:          tmpStr = ( nbElem <= 1 ) ? " edge"          : " edges";          break;
+      case GmfTriangles:      tmpStr = ( nbElem <= 1 ) ? " triangle"      : " triangles";      break;
+      case GmfQuadrilaterals: tmpStr = ( nbElem <= 1 ) ? " Quadrilateral" : " Quadrilaterals"; break;
+      case GmfTetrahedra:     tmpStr = ( nbElem <= 1 ) ? " Tetrahedron"   : " Tetrahedra";     break;
+      case GmfHexahedra:      tmpStr = ( nbElem <= 1 ) ? " Hexahedron"    : " Hexahedra";      break;
+      default:;
+      }
+      // node ids and domains of all elements of the token
+      std::map< GmfKwdCod, TGmfConnectivity >::iterator preRead = preReadConn.find( token );
+      if ( preRead != preReadConn.end() )
+      {
+        std::swap( conn, preRead->second );
+        preReadConn.erase( preRead );
+      }
+      else
+      {
+        const bool isVolume = ( token == GmfTetrahedra || token == GmfHexahedra );
+        const int maxDomain = ( isVolume && hasGeom ) ? int( solidIDByDomain.size() ) - 1 : anyDomain;
+        if ( !reader.Pop( chunk ) || !chunk._conn.IsValid( nbInitialNodes + nbVertices, maxDomain ))
+        {
+          theErrStr = badFileErr;
+          return false;
+        }
+        std::swap( conn, chunk._conn );
+      }
+
+      // reserve volumes of sub-domains and groups of domains
+      if ( hasGeom && ( token == GmfTetrahedra || token == GmfHexahedra ))
+        subDomainsOnSolids.Reserve( conn );
+      if ( toMakeGroupsOfDomains && ( token == GmfTetrahedra || token == GmfHexahedra ))
+      {
+        std::vector< int > nbElemsOfDomain( elemsOfDomain.size() );
+        for ( int iElem = 0; iElem < nbElem; iElem++ )
+        {
+          const size_t iDomain = conn.Domain( iElem );
+          if ( iDomain >= nbElemsOfDomain.size() )
+            nbElemsOfDomain.resize( iDomain + 1, 0 );
+          nbElemsOfDomain[ iDomain ]++;
+        }
+        if ( elemsOfDomain.size() < nbElemsOfDomain.size() )
+          elemsOfDomain.resize( nbElemsOfDomain.size() );
+        for ( size_t iDomain = 0; iDomain < nbElemsOfDomain.size(); ++iDomain )
+          elemsOfDomain[ iDomain ].reserve( elemsOfDomain[ iDomain ].size() +
+                                            nbElemsOfDomain[ iDomain ]);
+      }
+#ifdef _MY_DEBUG_
+      if ( token == GmfTetrahedra )
+        for ( int iElem = 0; iElem < nbElem; iElem++ )
+          subdomainId2tetraId[ conn.Domain( iElem )].insert( iElem+1 );
+#endif
+    }
+    std::cout << tmpStr << std::endl;
+    std::cout << std::endl;
+
+    switch (token) {
+    case GmfCorners:
+    case GmfRidges:
+    case GmfEdges:
+    case GmfTriangles:
+    case GmfQuadrilaterals:
+    case GmfTetrahedra:
+    case GmfHexahedra:
+    {
+      std::vector< const SMDS_MeshNode* > node( nbRef );
+      std::vector< int >          nodeID( nbRef );
+      std::vector< SMDS_MeshNode* > enfNode( nbRef );
+      const SMDS_MeshElement* aCreatedElem;
+
+      if ( existingVolumes && ( token == GmfTetrahedra || token == GmfHexahedra ))
+      {
+        // Issue 0020682. Avoid creating tetras at place where volumic elements
+        // already exist: check barycenters of all new volumes at once
+        pointsToCheck.assign( nbElem, gp_XYZ( 0, 0, 0 ));
+        isInExistingVolume.assign( nbElem, 0 );
+        for ( int iElem = 0; iElem < nbElem; iElem++ )
+        {
+          const int* elemNodeIDs = conn.Nodes( iElem );
+          for ( int iRef = 0; iRef < nbRef && !isInExistingVolume[ iElem ]; iRef++ )
+          {
+            aGMFNodeID = elemNodeIDs[ iRef ];
+            const SMDS_MeshNode* n = ( aGMFNodeID <= nbInitialNodes ?
+                                       theNodeByGhs3dId[ aGMFNodeID - 1 ] :
+                                       GMFNode[ aGMFNodeID - nbInitialNodes ]);
+            if ( n )
+              pointsToCheck[ iElem ] += SMESH_TNodeXYZ( n );
+            else
+              isInExistingVolume[ iElem ] = 1; // skip an element with a not created node
+          }
+          pointsToCheck[ iElem ] /= nbRef;
+        }
+        existingVolumes->FindPointsInVolumes( pointsToCheck, isInExistingVolume );
+      }
+
+      // if toRenumber, volumes are created sorted by sub-domain and then by
+      // the least ID of their nodes
+      std::vector< int > elemOrder;
+      if ( toRenumber && ( token == GmfTetrahedra || token == GmfHexahedra ))
+      {
+        typedef std::pair< std::pair< int, smIdType >, int > TKeyAndElem;
+        std::vector< TKeyAndElem > keyAndElem( nbElem );
+        for ( int iElem = 0; iElem < nbElem; iElem++ )
+        {
+          smIdType minNodeID = std::numeric_limits< smIdType >::max();
+          const int* elemNodeIDs = conn.Nodes( iElem );
+          for ( int iRef = 0; iRef < nbRef; iRef++ )
+          {
+            aGMFNodeID = elemNodeIDs[ iRef ];
+            const SMDS_MeshNode* n = ( aGMFNodeID <= nbInitialNodes ?
+                                       theNodeByGhs3dId[ aGMFNodeID - 1 ] :
+                                       GMFNode[ aGMFNodeID - nbInitialNodes ]);
+            if ( n )
+              minNodeID = std::min( minNodeID, n->GetID() );
+          }
+          keyAndElem[ iElem ] = TKeyAndElem( std::make_pair( conn.Domain( iElem ), minNodeID ), iElem );
+        }
+        std::sort( keyAndElem.begin(), keyAndElem.end() );
+        elemOrder.resize( nbElem );
+        for ( int i = 0; i < nbElem; i++ )
+          elemOrder[ i ] = keyAndElem[ i ].second;
+      }
+
+      for ( int i = 0; i < nbElem; i++ )
+      {
+        if(theAlgo->computeCanceled()) {
+          return false;
+        }
+        const int iElem = elemOrder.empty() ? i : elemOrder[ i ];
+        // Check if elem is already in input mesh. If yes => skip
+        bool fullyCreatedElement = false; // if at least one of the nodes was created
+        const int* elemNodeIDs = conn.Nodes( iElem );
+        for ( int iRef = 0; iRef < nbRef; iRef++ )
+        {
+          aGMFNodeID = elemNodeIDs[ iRef ];
+          if (aGMFNodeID <= nbInitialNodes) // input nodes
+          {
+            aGMFNodeID--;
+            nodeID[ iRef ] = 0;
+            node  [ iRef ] = theNodeByGhs3dId[aGMFNodeID];
+          }
+          else
+          {
+            fullyCreatedElement = true;
+            aGMFNodeID -= nbInitialNodes;
+            nodeID[ iRef ] = aGMFNodeID ;
+            node  [ iRef ] = GMFNode[ aGMFNodeID ];
+          }
+        }
+        aCreatedElem = 0;
+        switch (token)
+        {
+        case GmfEdges:
+          if (fullyCreatedElement) {
+            aCreatedElem = theHelper->AddEdge( node[0], node[1], noID, force3d );
+            if (anEdgeGroupByGhs3dId.size())
+              theGroups.Add( aCreatedElem, anEdgeGroupByGhs3dId[iElem] );
+          }
+          break;
+        case GmfTriangles:
+          if (fullyCreatedElement) {
+            aCreatedElem = theHelper->AddFace( node[0], node[1], node[2], noID, force3d );
+            if (aFaceGroupByGhs3dId.size())
+              theGroups.Add( aCreatedElem, aFaceGroupByGhs3dId[iElem] );
+          }
+          break;
+        case GmfQuadrilaterals:
+          if (fullyCreatedElement) {
+            aCreatedElem = theHelper->AddFace( node[0], node[1], node[2], node[3], noID, force3d );
+          }
+          break;
+        case GmfTetrahedra:
+          if ( hasGeom )
+          {
+            solidID = solidIDByDomain[ conn.Domain( iElem )];
+            if ( solidID != HOLE_ID )
+            {
+              aCreatedElem = theHelper->AddVolume( node[1], node[0], node[2], node[3],
+                                                   noID, force3d );
+              subDomainsOnSolids.AddVolume( aCreatedElem, conn.Domain( iElem ), &nodeID[0], 4 );
+              for ( int iN = 0; iN < 4; ++iN )
+                if ( nodeID[iN] == 0 && node[iN]->getshapeId() < 1 )
+                  theMeshDS->SetNodeInVolume( node[iN], solidID );
+            }
+          }
+          else
+          {
+            if ( existingVolumes && isInExistingVolume[ iElem ])
+              continue; // Issue 0020682
+            aCreatedElem = theHelper->AddVolume( node[1], node[0], node[2], node[3],
+                                                 noID, force3d );
+          }
+          break;
+        case GmfHexahedra:
+          if ( hasGeom )
+          {
+            solidID = solidIDByDomain[ conn.Domain( iElem )];
+            if ( solidID != HOLE_ID )
+            {
+              aCreatedElem = theHelper->AddVolume( node[0], node[3], node[2], node[1],
+                                                   node[4], node[7], node[6], node[5],
+                                                   noID, force3d );
+              subDomainsOnSolids.AddVolume( aCreatedElem, conn.Domain( iElem ), &nodeID[0], 8 );
+              for ( int iN = 0; iN < 8; ++iN )
+                if ( nodeID[iN] == 0 && node[iN]->getshapeId() < 1 )
+                  theMeshDS->SetNodeInVolume( node[iN], solidID );
+            }
+          }
+          else
+          {
+            if ( existingVolumes && isInExistingVolume[ iElem ])
+              continue; // Issue 0020682
+            aCreatedElem = theHelper->AddVolume( node[0], node[3], node[2], node[1],
+                                                 node[4], node[7], node[6], node[5],
+                                                 noID, force3d );
+          }
+          break;
+        default: continue;
+        } // switch (token)
+
+        // care about medium nodes
+        if ( aCreatedElem && aCreatedElem->IsQuadratic() )
+        {
+          if ( !hasGeom || aCreatedElem->GetType() != SMDSAbs_Volume ) // volumes are on solids later
+            solidID = aCreatedElem->getshapeId();
+          int iN = aCreatedElem->NbCornerNodes(), nbN = aCreatedElem->NbNodes();
+          for ( ; iN < nbN && solidID > 0; ++iN )
+          {
+            const SMDS_MeshNode* n = aCreatedElem->GetNode(iN);
+            if ( n->getshapeId() < 1 )
+              theMeshDS->SetNodeInVolume( n, solidID );
+          }
+        }
+
+        if ( aCreatedElem && toMakeGroupsOfDomains )
+        {
+          const int iDomain = conn.Domain( iElem );
+          if ( iDomain >= (int) elemsOfDomain.size() )
+            elemsOfDomain.resize( iDomain + 1 );
+          elemsOfDomain[ iDomain ].push_back( aCreatedElem );
+        }
+      } // loop on elements of one type
+      conn.Clear();
+      break;
+    } // case ...
+    default:;
+    } // switch (token)
+  } // loop on tabRef
+
+  // set new volumes and nodes on solids
+  subDomainsOnSolids.Flush();
+
+  // remove nodes in holes
+  if ( hasGeom )
+  {
+    for ( int i = 1; i <= nbVertices; ++i )
+      if ( GMFNode[i] && GMFNode[i]->NbInverseElements() == 0 )
+        theMeshDS->RemoveFreeNode( GMFNode[i], /*sm=*/0, /*fromGroups=*/false );
+  }
+
+  if ( !reader.Stop() )
+    MGOutput->GmfCloseMesh( InpMsh );
+
+  // 0022172: [CEA 790] create the groups corresponding to domains
+  if ( toMakeGroupsOfDomains )
+    makeDomainGroups( elemsOfDomain, theGroups );
+
+  // add new elements to groups of enforced elements and of domains
+  theGroups.Flush( theHelper->GetMesh() );
+
+#ifdef _MY_DEBUG_
+  std::map<int, std::set<int> >::const_iterator subdomainIt = subdomainId2tetraId.begin();
+  TCollection_AsciiString aSubdomainFileName = theFile;
+  aSubdomainFileName = aSubdomainFileName + ".subdomain";
+  ofstream aSubdomainFile  ( aSubdomainFileName.ToCString()  , ios::out);
+
+  aSubdomainFile << "Nb subdomains " << subdomainId2tetraId.size() << std::endl;
+  for(;subdomainIt != subdomainId2tetraId.end() ; ++subdomainIt) {
+    int subdomainId = subdomainIt->first;
+    std::set<int> tetraIds = subdomainIt->second;
+    std::set<int>::const_iterator tetraIdsIt = tetraIds.begin();
+    aSubdomainFile << subdomainId << std::endl;
+    for(;tetraIdsIt != tetraIds.end() ; ++tetraIdsIt) {
+      aSubdomainFile << (*tetraIdsIt) << " ";
+    }
+    aSubdomainFile << std::endl;
+  }
+  aSubdomainFile.close();
+#endif  
+  
+  return true;
+}
+
+
+namespace
+{
+  //=======================================================================
+  /*!
+   * \brief Index of MG-Tetra IDs of nodes. Nodes of the meshed mesh are
+   *        indexed by node ID in a dense array; nodes of other meshes (e.g.
+   *        of enforced meshes) are kept in an open-addressing hash table
+   *        keyed by node address. 0 means "no MG-Tetra ID".
+   */
+  //=======================================================================
+
+  class TNodeToGhs3dIdIndex
+  {
+    const SMDS_Mesh*                    _mesh;
+    std::vector< int >                  _idByNodeID; // for nodes of _mesh
+    std::vector< const SMDS_MeshNode* > _hashNodes;  // for nodes of other meshes
+    std::vector< int >                  _hashIDs;
+    size_t                              _nbHashed;
+    size_t                              _size;
+
+  public:
+
+    TNodeToGhs3dIdIndex( const SMDS_Mesh* mesh ): _mesh( mesh ), _nbHashed( 0 ), _size( 0 ) {}
+
+    //! Return MG-Tetra ID of a node or 0 if the node is not indexed
+    int Get( const SMDS_MeshNode* node ) const
+    {
+      if ( isOwn( node ))
+      {
+        smIdType id = node->GetID();
+        return id < (smIdType) _idByNodeID.size() ? _idByNodeID[ id ] : 0;
+      }
+      if ( _nbHashed == 0 )
+        return 0;
+      size_t i = hashIndex( node );
+      while ( _hashNodes[ i ] )
+      {
+        if ( _hashNodes[ i ] == node )
+          return _hashIDs[ i ];
+        i = ( i + 1 ) & ( _hashNodes.size() - 1 );
+      }
+      return 0;
+    }
+
+    //! Set MG-Tetra ID to a node unless it is already indexed. Return true if set
+    bool Insert( const SMDS_MeshNode* node, int ghs3dID )
+    {
+      if ( isOwn( node ))
+      {
+        smIdType id = node->GetID();
+        if ( id >= (smIdType) _idByNodeID.size() ) // allocate at the first insertion
+          _idByNodeID.resize( std::max( id, _mesh->MaxNodeID() ) + 1, 0 );
+        if ( _idByNodeID[ id ] )
+          return false;
+        _idByNodeID[ id ] = ghs3dID;
+        ++_size;
+        return true;
+      }
+      if ( 2 * ( _nbHashed + 1 ) > _hashNodes.size() )
+        rehash( std::max( size_t( 64 ), 2 * _hashNodes.size() ));
+      size_t i = hashIndex( node );
+      while ( _hashNodes[ i ] )
+      {
+        if ( _hashNodes[ i ] == node )
+          return false;
+        i = ( i + 1 ) & ( _hashNodes.size() - 1 );
+      }
+      _hashNodes[ i ] = node;
+      _hashIDs  [ i ] = ghs3dID;
+      ++_nbHashed;
+      ++_size;
+      return true;
+    }
+
+    //! Return number of indexed nodes
+    size_t Size() const { return _size; }
+
+    //! Change MG-Tetra IDs of all nodes: new ID = newIDByOld[ old ID ]
+    void Renumber( const std::vector< int >& newIDByOld )
+    {
+      for ( size_t i = 0; i < _idByNodeID.size(); ++i )
+        if ( _idByNodeID[ i ] )
+          _idByNodeID[ i ] = newIDByOld[ _idByNodeID[ i ]];
+      for ( size_t i = 0; i < _hashNodes.size(); ++i )
+        if ( _hashNodes[ i ] )
+          _hashIDs[ i ] = newIDByOld[ _hashIDs[ i ]];
+    }
+
+  private:
+
+    bool isOwn( const SMDS_MeshNode* node ) const
+    {
+      smIdType id = node->GetID();
+      return id > 0 && _mesh->FindNode( id ) == node;
+    }
+    size_t hashIndex( const SMDS_MeshNode* node ) const
+    {
+      size_t h = size_t( node ) >> 3;
+      h *= size_t( 0x9E3779B97F4A7C15ULL );
+      return ( h >> 16 ) & ( _hashNodes.size() - 1 );
+    }
+    void rehash( size_t capacity ) // capacity is a power of 2
+    {
+      std::vector< const SMDS_MeshNode* > oldNodes( capacity, (const SMDS_MeshNode*) 0 );
+      std::vector< int >                  oldIDs  ( capacity, 0 );
+      oldNodes.swap( _hashNodes );
+      oldIDs.swap  ( _hashIDs );
+      for ( size_t iOld = 0; iOld < oldNodes.size(); ++iOld )
+        if ( oldNodes[ iOld ])
+        {
+          size_t i = hashIndex( oldNodes[ iOld ]);
+          while ( _hashNodes[ i ] )
+            i = ( i + 1 ) & ( _hashNodes.size() - 1 );
+          _hashNodes[ i ] = oldNodes[ iOld ];
+          _hashIDs  [ i ] = oldIDs  [ iOld ];
+        }
+    }
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Spatial hash of points stored as packed coordinates. Points are
+   *        equal if their coordinates are bitwise equal (zero tolerance) or
+   *        if they are closer than a given tolerance.
+   */
+  //=======================================================================
+
+  class TPointHash
+  {
+    double                _tol;
+    std::vector< double > _xyz;   // 3 coordinates per point
+    std::vector< int >    _first; // first point of a bucket, -1 if none
+    std::vector< int >    _next;  // next point of the same bucket
+
+  public:
+
+    TPointHash( double tolerance = 0. ): _tol( tolerance ) {}
+
+    void Reserve( size_t nbPoints )
+    {
+      _xyz.reserve( 3 * nbPoints );
+      _next.reserve( nbPoints );
+    }
+
+    //! Add a point
+    void Add( double x, double y, double z )
+    {
+      if ( _next.size() + 1 > _first.size() / 2 )
+        rehash( std::max( size_t( 64 ), 2 * _first.size() ));
+      int iPnt = (int) _next.size();
+      _xyz.push_back( x );
+      _xyz.push_back( y );
+      _xyz.push_back( z );
+      size_t iB = bucket( cell( x ), cell( y ), cell( z ));
+      _next.push_back( _first[ iB ]);
+      _first[ iB ] = iPnt;
+    }
+
+    //! Check if an equal point is already added
+    bool Contains( double x, double y, double z ) const
+    {
+      if ( _next.empty() )
+        return false;
+      const long long cx = cell( x ), cy = cell( y ), cz = cell( z );
+      if ( _tol <= 0. )
+        return find( bucket( cx, cy, cz ), x, y, z );
+
+      for ( long long ix = cx - 1; ix <= cx + 1; ++ix )
+        for ( long long iy = cy - 1; iy <= cy + 1; ++iy )
+          for ( long long iz = cz - 1; iz <= cz + 1; ++iz )
+            if ( find( bucket( ix, iy, iz ), x, y, z ))
+              return true;
+      return false;
+    }
+
+    size_t Size() const { return _next.size(); }
+
+  private:
+
+    long long cell( double v ) const
+    {
+      if ( _tol > 0. )
+        return (long long) std::floor( v / _tol );
+      v += 0.; // -0. -> +0.
+      long long bits;
+      std::memcpy( &bits, &v, sizeof( bits ));
+      return bits;
+    }
+    size_t bucket( long long cx, long long cy, long long cz ) const
+    {
+      unsigned long long h = (unsigned long long) cx * 0x9E3779B97F4A7C15ULL;
+      h ^= (unsigned long long) cy * 0xC2B2AE3D27D4EB4FULL + ( h >> 29 );
+      h ^= (unsigned long long) cz * 0x165667B19E3779F9ULL + ( h >> 31 );
+      return size_t( h ^ ( h >> 32 )) & ( _first.size() - 1 );
+    }
+    bool find( size_t iB, double x, double y, double z ) const
+    {
+      for ( int i = _first[ iB ]; i >= 0; i = _next[ i ])
+      {
+        const double* p = & _xyz[ 3 * i ];
+        if ( _tol <= 0. )
+        {
+          if ( p[0] == x && p[1] == y && p[2] == z )
+            return true;
+        }
+        else
+        {
+          double dx = p[0] - x, dy = p[1] - y, dz = p[2] - z;
+          if ( dx * dx + dy * dy + dz * dz <= _tol * _tol )
+            return true;
+        }
+      }
+      return false;
+    }
+    void rehash( size_t nbBuckets ) // nbBuckets is a power of 2
+    {
+      _first.assign( nbBuckets, -1 );
+      for ( size_t i = 0; i < _next.size(); ++i )
+      {
+        const double* p = & _xyz[ 3 * i ];
+        size_t iB = bucket( cell( p[0] ), cell( p[1] ), cell( p[2] ));
+        _next[ i ] = _first[ iB ];
+        _first[ iB ] = (int) i;
+      }
+    }
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Return distance within which an enforced node coincides with a node
+   *        passed to MG-Tetra or with an enforced vertex: value of
+   *        MG_TETRA_ENFORCED_NODE_TOLERANCE environment variable, zero by
+   *        default (coordinates must be equal)
+   */
+  //=======================================================================
+
+  double enforcedNodeTolerance()
+  {
+    if ( const char* tol = getenv("MG_TETRA_ENFORCED_NODE_TOLERANCE"))
+      return std::max( 0., atof( tol ));
+    return 0.;
+  }
+
+  //=======================================================================
+  /*!
+   * \brief Faces and nodes of a mesh distributed over cells of a uniform grid.
+   *
+   * The grid is built once and then queried by several threads at a time.
+   * GetPointState() repeats the rough analysis of
+   * SMESH_ElementSearcher::GetPointState(): faces intersected by lines
+   * parallel to the axes are counted before and after a point. A point is
+   * left unclassified if the lines pass through boundaries of faces or if
+   * the numbers of intersections are not conclusive.
+   */
+  //=======================================================================
+
+  class TSurfaceGrid
+  {
+  public:
+
+    TSurfaceGrid( SMESHDS_Mesh* mesh ): _tol( 0 ), _cellSize( 1 )
+    {
+      _faces.reserve( mesh->NbFaces() );
+      double sumFaceSize = 0;
+      SMDS_ElemIteratorPtr faceIt = mesh->elementsIterator( SMDSAbs_Face );
+      while ( faceIt->more() )
+      {
+        const SMDS_MeshElement* face = faceIt->next();
+        Bnd_B3d faceBox = boxOf( face );
+        sumFaceSize += std::sqrt( faceBox.SquareExtent() );
+        _box.Add( faceBox );
+        _faces.push_back( face );
+      }
+      // same tolerance as that of SMESH_ElementSearcher
+      if ( !_box.IsVoid() )
+        _tol = 1e-8 * maxSide( _box );
+
+      _nodes.reserve( mesh->NbNodes() );
+      SMDS_NodeIteratorPtr nodeIt = mesh->nodesIterator();
+      while ( nodeIt->more() )
+      {
+        const SMDS_MeshNode* node = nodeIt->next();
+        _box.Add( SMESH_TNodeXYZ( node ));
+        _nodes.push_back( node );
+      }
+      if ( _box.IsVoid() )
+        return;
+      if ( _faces.empty() )
+        _tol = 1e-8 * maxSide( _box );
+
+      // cells are about as big as faces, their number is about that of elements
+      const size_t nbElems = std::max( _faces.size(), _nodes.size() );
+      if ( !_faces.empty() )
+        _cellSize = sumFaceSize / double( _faces.size() );
+      else
+        _cellSize = maxSide( _box ) / std::cbrt( double( nbElems ));
+      _cellSize = std::max( _cellSize, 1e-6 * maxSide( _box ));
+      if ( _cellSize <= 0 )
+        _cellSize = 1;
+      const gp_XYZ size = _box.CornerMax() - _box.CornerMin();
+      for ( ;; _cellSize *= 1.5 )
+      {
+        double nbCells = 1;
+        for ( int iAxis = 0; iAxis < 3; ++iAxis )
+          nbCells *= 1. + std::floor( size.Coord( iAxis + 1 ) / _cellSize );
+        if ( nbCells <= 2. * double( nbElems ) + 8. )
+          break;
+      }
+      for ( int iAxis = 0; iAxis < 3; ++iAxis )
+        _nbCells[ iAxis ] = 1 + int( size.Coord( iAxis + 1 ) / _cellSize );
+      const size_t nbCells = size_t( _nbCells[0] ) * _nbCells[1] * _nbCells[2];
+
+      // count items per cell, then fill the cells
+      _faceStart.assign( nbCells + 1, 0 );
+      _nodeStart.assign( nbCells + 1, 0 );
+      for ( int isFilling = 0; isFilling < 2; ++isFilling )
+      {
+        std::vector< int > facePos( _faceStart.begin(), _faceStart.end() - 1 );
+        std::vector< int > nodePos( _nodeStart.begin(), _nodeStart.end() - 1 );
+        for ( size_t iF = 0; iF < _faces.size(); ++iF )
+        {
+          Bnd_B3d faceBox = boxOf( _faces[ iF ]);
+          int ijkMin[3], ijkMax[3], ijk[3];
+          cellOf( faceBox.CornerMin(), ijkMin );
+          cellOf( faceBox.CornerMax(), ijkMax );
+          for ( ijk[0] = ijkMin[0]; ijk[0] <= ijkMax[0]; ++ijk[0] )
+            for ( ijk[1] = ijkMin[1]; ijk[1] <= ijkMax[1]; ++ijk[1] )
+              for ( ijk[2] = ijkMin[2]; ijk[2] <= ijkMax[2]; ++ijk[2] )
+              {
+                const size_t iCell = cellIndex( ijk );
+                if ( isFilling )
+                  _cellFaces[ facePos[ iCell ]++ ] = int( iF );
+                else
+                  ++_faceStart[ iCell + 1 ];
+              }
+        }
+        for ( size_t iN = 0; iN < _nodes.size(); ++iN )
+        {
+          int ijk[3];
+          cellOf( SMESH_TNodeXYZ( _nodes[ iN ]), ijk );
+          const size_t iCell = cellIndex( ijk );
+          if ( isFilling )
+            _cellNodes[ nodePos[ iCell ]++ ] = int( iN );
+          else
+            ++_nodeStart[ iCell + 1 ];
+        }
+        if ( !isFilling )
+        {
+          for ( size_t iCell = 0; iCell < nbCells; ++iCell )
+          {
+            _faceStart[ iCell + 1 ] += _faceStart[ iCell ];
+            _nodeStart[ iCell + 1 ] += _nodeStart[ iCell ];
+          }
+          _cellFaces.resize( _faceStart.back() );
+          _cellNodes.resize( _nodeStart.back() );
+        }
+      }
+    }
+
+    //================================================================================
+    /*!
+     * \brief Classify a point relative to the faces
+     *  \return bool - false if the point remains unclassified
+     */
+    //================================================================================
+
+    bool GetPointState( const gp_XYZ& p, TopAbs_State& state ) const
+    {
+      if ( _faces.empty() )
+        return false;
+
+      std::multimap< int, int > nbInt2Axis; // min nb of intersections on a side -> axis
+      int nbBefore[3], nbAfter[3];
+      for ( int iAxis = 0; iAxis < 3; ++iAxis )
+      {
+        bool isOn = false;
+        if ( countIntersections( p, iAxis, nbBefore[ iAxis ], nbAfter[ iAxis ], isOn ))
+          nbInt2Axis.insert( std::make_pair( std::min( nbBefore[ iAxis ], nbAfter[ iAxis ]), iAxis ));
+        if ( isOn )
+        {
+          state = TopAbs_ON;
+          return true;
+        }
+      }
+
+      std::multimap< int, int >::const_iterator nb_axis = nbInt2Axis.begin();
+      for ( ; nb_axis != nbInt2Axis.end(); ++nb_axis )
+      {
+        const int nbB = nbBefore[ nb_axis->second ];
+        const int nbA = nbAfter [ nb_axis->second ];
+        if ( nbB == 0 || nbA == 0 )
+          state = TopAbs_OUT;
+        else if ( nbB == 1 || nbA == 1 )
+          state = TopAbs_IN;
+        else if (( nbB + nbA ) % 2 == 0 )
+          state = ( nbB % 2 ) ? TopAbs_IN : TopAbs_OUT;
+        else
+          continue;
+        return true;
+      }
+      return false;
+    }
+
+    //================================================================================
+    /*!
+     * \brief Find nodes coincident with a point
+     *  \param [out] node - the first found node
+     *  \return int - number of found nodes
+     */
+    //================================================================================
+
+    int FindNodes( const gp_XYZ& p, const SMDS_MeshNode*& node ) const
+    {
+      node = 0;
+      int nbFound = 0;
+      if ( _nodes.empty() )
+        return nbFound;
+
+      const gp_XYZ delta( _tol, _tol, _tol );
+      int ijkMin[3], ijkMax[3], ijk[3];
+      cellOf( p - delta, ijkMin );
+      cellOf( p + delta, ijkMax );
+      for ( ijk[0] = ijkMin[0]; ijk[0] <= ijkMax[0]; ++ijk[0] )
+        for ( ijk[1] = ijkMin[1]; ijk[1] <= ijkMax[1]; ++ijk[1] )
+          for ( ijk[2] = ijkMin[2]; ijk[2] <= ijkMax[2]; ++ijk[2] )
+          {
+            const size_t iCell = cellIndex( ijk );
+            for ( int i = _nodeStart[ iCell ]; i < _nodeStart[ iCell + 1 ]; ++i )
+            {
+              const SMDS_MeshNode* n = _nodes[ _cellNodes[ i ]];
+              if (( SMESH_TNodeXYZ( n ) - p ).SquareModulus() <= _tol * _tol )
+              {
+                if ( nbFound++ == 0 )
+                  node = n;
+              }
+            }
+          }
+      return nbFound;
+    }
+
+  private:
+
+    enum TIntersection { NO_INTERSECTION, INTERSECTION, ON_TRIA_BOUNDARY };
+
+    static Bnd_B3d boxOf( const SMDS_MeshElement* face )
+    {
+      Bnd_B3d box;
+      for ( int i = 0, nb = face->NbCornerNodes(); i < nb; ++i )
+        box.Add( SMESH_TNodeXYZ( face->GetNode( i )));
+      return box;
+    }
+    static double maxSide( const Bnd_B3d& box )
+    {
+      const gp_XYZ size = box.CornerMax() - box.CornerMin();
+      return std::max( size.X(), std::max( size.Y(), size.Z() ));
+    }
+    int cellOf( double coord, int iAxis ) const
+    {
+      const double i = ( coord - _box.CornerMin().Coord( iAxis + 1 )) / _cellSize;
+      return ( i <= 0 ) ? 0 : ( i >= _nbCells[ iAxis ] - 1 ) ? _nbCells[ iAxis ] - 1 : int( i );
+    }
+    void cellOf( const gp_XYZ& p, int ijk[3] ) const
+    {
+      for ( int iAxis = 0; iAxis < 3; ++iAxis )
+        ijk[ iAxis ] = cellOf( p.Coord( iAxis + 1 ), iAxis );
+    }
+    size_t cellIndex( const int ijk[3] ) const
+    {
+      return ( size_t( ijk[0] ) * _nbCells[1] + ijk[1] ) * _nbCells[2] + ijk[2];
+    }
+
+    //================================================================================
+    /*!
+     * \brief Count intersections of faces with a line passing through a point
+     *        parallel to an axis
+     *  \return bool - false if the line passes through a boundary of a triangle
+     */
+    //================================================================================
+
+    bool countIntersections( const gp_XYZ& p, int iAxis, int& nbBefore, int& nbAfter,
+                             bool& isOn ) const
+    {
+      nbBefore = nbAfter = 0;
+      int ijk[3];
+      cellOf( p, ijk );
+      for ( ijk[ iAxis ] = 0; ijk[ iAxis ] < _nbCells[ iAxis ]; ++ijk[ iAxis ])
+      {
+        const size_t iCell = cellIndex( ijk );
+        for ( int i = _faceStart[ iCell ]; i < _faceStart[ iCell + 1 ]; ++i )
+        {
+          const SMDS_MeshElement* face = _faces[ _cellFaces[ i ]];
+          const SMESH_TNodeXYZ n0( face->GetNode( 0 ));
+          for ( int iT = 1, nb = face->NbCornerNodes(); iT + 1 < nb; ++iT ) // fan of triangles
+          {
+            double t;
+            switch ( intersect( p, iAxis, n0, SMESH_TNodeXYZ( face->GetNode( iT )),
+                                SMESH_TNodeXYZ( face->GetNode( iT + 1 )), t ))
+            {
+            case NO_INTERSECTION:  continue;
+            case ON_TRIA_BOUNDARY: return false;
+            case INTERSECTION:     break;
+            }
+            if ( std::abs( t ) <= _tol )
+            {
+              isOn = true;
+              return false;
+            }
+            // a face in several cells is counted in the cell of the intersection
+            if ( cellOf( p.Coord( iAxis + 1 ) + t, iAxis ) != ijk[ iAxis ])
+              continue;
+            if ( t < 0 )
+              ++nbBefore;
+            else
+              ++nbAfter;
+          }
+        }
+      }
+      return true;
+    }
+
+    //================================================================================
+    /*!
+     * \brief Intersect a triangle with a line passing through a point parallel to an axis
+     *  \param [out] t - distance from the point to the intersection along the axis
+     */
+    //================================================================================
+
+    static TIntersection intersect( const gp_XYZ& p, int iAxis,
+                                    const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c,
+                                    double& t )
+    {
+      const int iB = ( iAxis + 1 ) % 3 + 1, iC = ( iAxis + 2 ) % 3 + 1, iA = iAxis + 1;
+
+      const double pb  = p.Coord( iB ) - a.Coord( iB ), pc  = p.Coord( iC ) - a.Coord( iC );
+      const double e1b = b.Coord( iB ) - a.Coord( iB ), e1c = b.Coord( iC ) - a.Coord( iC );
+      const double e2b = c.Coord( iB ) - a.Coord( iB ), e2c = c.Coord( iC ) - a.Coord( iC );
+      const double det = e1b * e2c - e2b * e1c;
+      const double eps = 1e-9;
+
+      const double len1 = e1b * e1b + e1c * e1c, len2 = e2b * e2b + e2c * e2c;
+      if ( det * det <= eps * eps * len1 * len2 )
+      {
+        // the triangle is parallel to the line; the line is on its boundary
+        // if it passes through a segment the triangle is projected to
+        const double eb = ( len1 > len2 ) ? e1b : e2b, ec = ( len1 > len2 ) ? e1c : e2c;
+        const double len = std::max( len1, len2 );
+        if ( len == 0. )
+          return ( pb * pb + pc * pc == 0. ) ? ON_TRIA_BOUNDARY : NO_INTERSECTION;
+        if ( std::abs( eb * pc - ec * pb ) > eps * len )
+          return NO_INTERSECTION;
+        const double u = ( eb * pb + ec * pc ) / len; // position along the segment
+        const double uOther = ( len1 > len2 ) ? ( e2b * eb + e2c * ec ) / len : ( e1b * eb + e1c * ec ) / len;
+        const double uMin = std::min( 0., uOther ), uMax = std::max( 1., uOther );
+        return ( u < uMin - eps || u > uMax + eps ) ? NO_INTERSECTION : ON_TRIA_BOUNDARY;
+      }
+      const double l1 = ( pb * e2c - e2b * pc ) / det;
+      const double l2 = ( e1b * pc - pb * e1c ) / det;
+      const double l0 = 1. - l1 - l2;
+      if ( l0 < -eps || l1 < -eps || l2 < -eps )
+        return NO_INTERSECTION;
+      if ( l0 < eps || l1 < eps || l2 < eps )
+        return ON_TRIA_BOUNDARY;
+
+      t = l0 * a.Coord( iA ) + l1 * b.Coord( iA ) + l2 * c.Coord( iA ) - p.Coord( iA );
+      return INTERSECTION;
+    }
+
+    double                                 _tol;
+    double                                 _cellSize;
+    int                                    _nbCells[3];
+    Bnd_B3d                                _box;
+    std::vector< const SMDS_MeshElement* > _faces;
+    std::vector< const SMDS_MeshNode* >    _nodes;
+    std::vector< int >                     _faceStart; // first item of a cell in _cellFaces
+    std::vector< int >                     _cellFaces; // indices of _faces by cells
+    std::vector< int >                     _nodeStart; // first item of a cell in _cellNodes
+    std::vector< int >                     _cellNodes; // indices of _nodes by cells
+  };
 
-      
-      int aGMFID;
+  //=======================================================================
+  /*!
+   * \brief Classification of enforced nodes and vertices relative to the
+   *        meshed domain.
+   *
+   * Unique points are collected first, then each point is classified once.
+   * Chunks of points are processed in parallel by one TSurfaceGrid shared
+   * by all threads; a point the grid leaves unclassified is classified by an
+   * SMESH_ElementSearcher afterwards. Optionally, mesh nodes coincident with a
+   * point are looked for.
+   */
+  //=======================================================================
 
-      float VerTab_f[3];
-      double x, y, z;
-      const SMDS_MeshNode * aGMFNode;
+  class TEnforcedPoints
+  {
+  public:
 
-      for ( int iElem = 0; iElem < nbElem; iElem++ ) {
-        if(theAlgo->computeCanceled()) {
-          return false;
-        }
-        if (ver == GmfFloat) {
-          MGOutput->GmfGetLin( InpMsh, token, &VerTab_f[0], &VerTab_f[1], &VerTab_f[2], &dummy);
-          x = VerTab_f[0];
-          y = VerTab_f[1];
-          z = VerTab_f[2];
-        }
-        else {
-          MGOutput->GmfGetLin( InpMsh, token, &x, &y, &z, &dummy);
-        }
-        if (iElem >= nbInitialNodes) {
-          if ( elemSearcher &&
-                elemSearcher->FindElementsByPoint( gp_Pnt(x,y,z), SMDSAbs_Volume, foundVolumes))
-            aGMFNode = 0;
-          else
-            aGMFNode = theHelper->AddNode(x, y, z);
-          
-          aGMFID = iElem -nbInitialNodes +1;
-          GMFNode[ aGMFID ] = aGMFNode;
-          if (aGMFID-1 < (int)aNodeGroupByGhs3dId.size() && !aNodeGroupByGhs3dId.at(aGMFID-1).empty())
-            addElemInMeshGroup(theHelper->GetMesh(), aGMFNode, aNodeGroupByGhs3dId.at(aGMFID-1), groupsToRemove);
-        }
+    TEnforcedPoints( SMESHDS_Mesh* mesh ): _mesh( mesh ) {}
+
+    int AddNode( const SMDS_MeshNode* node, bool toFindNodes )
+    {
+      std::pair< TIndexByNode::iterator, bool > it_isNew =
+        _indexByNode.insert( std::make_pair( node, int( _xyz.size() )));
+      if ( it_isNew.second )
+      {
+        _xyz.push_back( SMESH_TNodeXYZ( node ));
+        _toFindNodes.push_back( toFindNodes );
       }
+      else if ( toFindNodes )
+      {
+        _toFindNodes[ it_isNew.first->second ] = true;
+      }
+      return it_isNew.first->second;
     }
-    else if (token == GmfCorners && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " corner" : tmpStr = " corners";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0]);
-    }
-    else if (token == GmfRidges && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " ridge" : tmpStr = " ridges";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0]);
-    }
-    else if (token == GmfEdges && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " edge" : tmpStr = " edges";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0], &id[iElem][1], &domainID[iElem]);
-    }
-    else if (token == GmfTriangles && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " triangle" : tmpStr = " triangles";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0], &id[iElem][1], &id[iElem][2], &domainID[iElem]);
-    }
-    else if (token == GmfQuadrilaterals && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " Quadrilateral" : tmpStr = " Quadrilaterals";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0], &id[iElem][1], &id[iElem][2], &id[iElem][3], &domainID[iElem]);
+
+    int AddPoint( double x, double y, double z )
+    {
+      _xyz.push_back( gp_XYZ( x, y, z ));
+      _toFindNodes.push_back( false );
+      return int( _xyz.size() - 1 );
     }
-    else if (token == GmfTetrahedra && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " Tetrahedron" : tmpStr = " Tetrahedra";
-      for ( int iElem = 0; iElem < nbElem; iElem++ ) {
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0], &id[iElem][1], &id[iElem][2], &id[iElem][3], &domainID[iElem]);
-#ifdef _MY_DEBUG_
-        subdomainId2tetraId[dummy].insert(iElem+1);
-#endif
+
+    void Classify()
+    {
+      _state.assign( _xyz.size(), TopAbs_UNKNOWN );
+      _nbFoundNodes.assign( _xyz.size(), 0 );
+      _foundNode.assign( _xyz.size(), (const SMDS_MeshNode*) 0 );
+      if ( _xyz.empty() )
+        return;
+
+      TSurfaceGrid grid( _mesh );
+
+      const int minChunkSize = 256;
+      int nbChunks = std::max( 1, OSD_Parallel::NbLogicalProcessors() );
+      nbChunks = std::min( nbChunks, int( _xyz.size() + minChunkSize - 1 ) / minChunkSize );
+      OSD_Parallel::For( 0, nbChunks, TClassify( *this, grid, nbChunks ), nbChunks == 1 );
+
+      // points the grid fails to classify, e.g. lying on edges of faces
+      std::vector< int > toSearch;
+      for ( size_t i = 0; i < _xyz.size(); ++i )
+        if ( _state[i] == TopAbs_UNKNOWN )
+          toSearch.push_back( int( i ));
+      if ( toSearch.empty() )
+        return;
+
+      SMESHUtils::Deleter< SMESH_ElementSearcher > searcher
+        ( SMESH_MeshAlgos::GetElementSearcher( *_mesh ));
+      for ( size_t i = 0; i < toSearch.size(); ++i )
+      {
+        const int iP = toSearch[i];
+        _state[ iP ] = searcher->GetPointState( gp_Pnt( _xyz[ iP ]));
+        findNodes( iP, grid );
       }
     }
-    else if (token == GmfHexahedra && nbElem > 0) {
-      (nbElem <= 1) ? tmpStr = " Hexahedron" : tmpStr = " Hexahedra";
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
-        MGOutput->GmfGetLin( InpMsh, token, &id[iElem][0], &id[iElem][1], &id[iElem][2], &id[iElem][3],
-                  &id[iElem][4], &id[iElem][5], &id[iElem][6], &id[iElem][7], &domainID[iElem]);
+
+    TopAbs_State         State       ( int i ) const { return TopAbs_State( _state[i] ); }
+    int                  NbFoundNodes( int i ) const { return _nbFoundNodes[i]; }
+    const SMDS_MeshNode* FoundNode   ( int i ) const { return _foundNode[i]; }
+
+    int Index( const SMDS_MeshNode* node ) const { return _indexByNode.find( node )->second; }
+
+  private:
+
+    void findNodes( int i, const TSurfaceGrid& grid )
+    {
+      if ( _toFindNodes[i] && _state[i] != TopAbs_OUT )
+        _nbFoundNodes[i] = grid.FindNodes( _xyz[i], _foundNode[i] );
+      if ( _nbFoundNodes[i] != 1 )
+        _foundNode[i] = 0;
     }
-    std::cout << tmpStr << std::endl;
-    std::cout << std::endl;
 
-    switch (token) {
-    case GmfCorners:
-    case GmfRidges:
-    case GmfEdges:
-    case GmfTriangles:
-    case GmfQuadrilaterals:
-    case GmfTetrahedra:
-    case GmfHexahedra:
+    struct TClassify // classify a chunk of points
     {
-      std::vector< const SMDS_MeshNode* > node( nbRef );
-      std::vector< int >          nodeID( nbRef );
-      std::vector< SMDS_MeshNode* > enfNode( nbRef );
-      const SMDS_MeshElement* aCreatedElem;
+      TEnforcedPoints&    _points;
+      const TSurfaceGrid& _grid;
+      int                 _nbChunks;
+
+      TClassify( TEnforcedPoints& points, const TSurfaceGrid& grid, int nbChunks )
+        : _points( points ), _grid( grid ), _nbChunks( nbChunks ) {}
 
-      for ( int iElem = 0; iElem < nbElem; iElem++ )
+      void operator()( int iChunk ) const
       {
-        if(theAlgo->computeCanceled()) {
-          return false;
-        }
-        // Check if elem is already in input mesh. If yes => skip
-        bool fullyCreatedElement = false; // if at least one of the nodes was created
-        for ( int iRef = 0; iRef < nbRef; iRef++ )
-        {
-          aGMFNodeID = id[iElem][iRef]; // read nbRef aGMFNodeID
-          if (aGMFNodeID <= nbInitialNodes) // input nodes
-          {
-            aGMFNodeID--;
-            node[ iRef ] = theNodeByGhs3dId[aGMFNodeID];
-          }
-          else
-          {
-            fullyCreatedElement = true;
-            aGMFNodeID -= nbInitialNodes;
-            nodeID[ iRef ] = aGMFNodeID ;
-            node  [ iRef ] = GMFNode[ aGMFNodeID ];
-          }
-        }
-        aCreatedElem = 0;
-        switch (token)
-        {
-        case GmfEdges:
-          if (fullyCreatedElement) {
-            aCreatedElem = theHelper->AddEdge( node[0], node[1], noID, force3d );
-            if (anEdgeGroupByGhs3dId.size() && !anEdgeGroupByGhs3dId[iElem].empty())
-              addElemInMeshGroup(theHelper->GetMesh(), aCreatedElem, anEdgeGroupByGhs3dId[iElem], groupsToRemove);
-          }
-          break;
-        case GmfTriangles:
-          if (fullyCreatedElement) {
-            aCreatedElem = theHelper->AddFace( node[0], node[1], node[2], noID, force3d );
-            if (aFaceGroupByGhs3dId.size() && !aFaceGroupByGhs3dId[iElem].empty())
-              addElemInMeshGroup(theHelper->GetMesh(), aCreatedElem, aFaceGroupByGhs3dId[iElem], groupsToRemove);
-          }
-          break;
-        case GmfQuadrilaterals:
-          if (fullyCreatedElement) {
-            aCreatedElem = theHelper->AddFace( node[0], node[1], node[2], node[3], noID, force3d );
-          }
-          break;
-        case GmfTetrahedra:
-          if ( hasGeom )
-          {
-            solidID = solidIDByDomain[ domainID[iElem]];
-            if ( solidID != HOLE_ID )
-            {
-              aCreatedElem = theHelper->AddVolume( node[1], node[0], node[2], node[3],
-                                                   noID, force3d );
-              theMeshDS->SetMeshElementOnShape( aCreatedElem, solidID );
-              for ( int iN = 0; iN < 4; ++iN )
-                if ( node[iN]->getshapeId() < 1 )
-                  theMeshDS->SetNodeInVolume( node[iN], solidID );
-            }
-          }
-          else
-          {
-            if ( elemSearcher ) {
-              // Issue 0020682. Avoid creating nodes and tetras at place where
-              // volumic elements already exist
-              if ( !node[1] || !node[0] || !node[2] || !node[3] )
-                continue;
-              if ( elemSearcher->FindElementsByPoint((SMESH_TNodeXYZ(node[0]) +
-                                                      SMESH_TNodeXYZ(node[1]) +
-                                                      SMESH_TNodeXYZ(node[2]) +
-                                                      SMESH_TNodeXYZ(node[3]) ) / 4.,
-                                                     SMDSAbs_Volume, foundVolumes ))
-                break;
-            }
-            aCreatedElem = theHelper->AddVolume( node[1], node[0], node[2], node[3],
-                                                 noID, force3d );
-          }
-          break;
-        case GmfHexahedra:
-          if ( hasGeom )
-          {
-            solidID = solidIDByDomain[ domainID[iElem]];
-            if ( solidID != HOLE_ID )
-            {
-              aCreatedElem = theHelper->AddVolume( node[0], node[3], node[2], node[1],
-                                                   node[4], node[7], node[6], node[5],
-                                                   noID, force3d );
-              theMeshDS->SetMeshElementOnShape( aCreatedElem, solidID );
-              for ( int iN = 0; iN < 8; ++iN )
-                if ( node[iN]->getshapeId() < 1 )
-                  theMeshDS->SetNodeInVolume( node[iN], solidID );
-            }
-          }
-          else
-          {
-            if ( elemSearcher ) {
-              // Issue 0020682. Avoid creating nodes and tetras at place where
-              // volumic elements already exist
-              if ( !node[1] || !node[0] || !node[2] || !node[3] || !node[4] || !node[5] || !node[6] || !node[7])
-                continue;
-              if ( elemSearcher->FindElementsByPoint((SMESH_TNodeXYZ(node[0]) +
-                                                      SMESH_TNodeXYZ(node[1]) +
-                                                      SMESH_TNodeXYZ(node[2]) +
-                                                      SMESH_TNodeXYZ(node[3]) +
-                                                      SMESH_TNodeXYZ(node[4]) +
-                                                      SMESH_TNodeXYZ(node[5]) +
-                                                      SMESH_TNodeXYZ(node[6]) +
-                                                      SMESH_TNodeXYZ(node[7])) / 8.,
-                                                     SMDSAbs_Volume, foundVolumes ))
-                break;
-            }
-            aCreatedElem = theHelper->AddVolume( node[0], node[3], node[2], node[1],
-                                                 node[4], node[7], node[6], node[5],
-                                                 noID, force3d );
-          }
-          break;
-        default: continue;
-        } // switch (token)
+        const size_t chunkSize = ( _points._xyz.size() + _nbChunks - 1 ) / _nbChunks;
+        const size_t iBeg = iChunk * chunkSize;
+        const size_t iEnd = std::min( iBeg + chunkSize, _points._xyz.size() );
 
-        // care about medium nodes
-        if ( aCreatedElem &&
-             aCreatedElem->IsQuadratic() &&
-             ( solidID = aCreatedElem->getshapeId() ) > 0 )
+        for ( size_t i = iBeg; i < iEnd; ++i )
         {
-          int iN = aCreatedElem->NbCornerNodes(), nbN = aCreatedElem->NbNodes();
-          for ( ; iN < nbN; ++iN )
-          {
-            const SMDS_MeshNode* n = aCreatedElem->GetNode(iN);
-            if ( n->getshapeId() < 1 )
-              theMeshDS->SetNodeInVolume( n, solidID );
-          }
+          TopAbs_State state;
+          if ( !_grid.GetPointState( _points._xyz[i], state ))
+            continue; // left for SMESH_ElementSearcher
+          _points._state[i] = state;
+          _points.findNodes( int( i ), _grid );
         }
+      }
+    };
 
-        if ( aCreatedElem && toMakeGroupsOfDomains )
-        {
-          if ( domainID[iElem] >= (int) elemsOfDomain.size() )
-            elemsOfDomain.resize( domainID[iElem] + 1 );
-          elemsOfDomain[ domainID[iElem] ].push_back( aCreatedElem );
-        }
-      } // loop on elements of one type
-      break;
-    } // case ...
-    default:;
-    } // switch (token)
-  } // loop on tabRef
+    typedef std::unordered_map< const SMDS_MeshNode*, int > TIndexByNode;
 
-  // remove nodes in holes
-  if ( hasGeom )
+    SMESHDS_Mesh*                       _mesh;
+    TIndexByNode                        _indexByNode;
+    std::vector< gp_XYZ >               _xyz;
+    std::vector< char >                 _toFindNodes;
+    std::vector< int >                  _state;
+    std::vector< int >                  _nbFoundNodes;
+    std::vector< const SMDS_MeshNode* > _foundNode;
+  };
+
+  //=======================================================================
+  /*!
+   * \brief Faces of a surface sub-mesh and their corner nodes, gathered
+   *        independently of other sub-meshes
+   */
+  //=======================================================================
+
+  struct TSurfaceChunk
   {
-    for ( int i = 1; i <= nbVertices; ++i )
-      if ( GMFNode[i]->NbInverseElements() == 0 )
-        theMeshDS->RemoveFreeNode( GMFNode[i], /*sm=*/0, /*fromGroups=*/false );
-  }
+    SMDS_ElemIteratorPtr                   _faceIt;
+    std::vector< const SMDS_MeshElement* > _faces;
+    std::vector< const SMDS_MeshNode* >    _nodes;   // corner nodes of _faces
+    std::vector< unsigned char >           _nbNodes; // nb corner nodes per face
+
+    void Gather()
+    {
+      while ( _faceIt->more() )
+      {
+        const SMDS_MeshElement* face = _faceIt->next();
+        const int nbCorners = face->NbCornerNodes();
+        _faces.push_back( face );
+        _nbNodes.push_back( (unsigned char) nbCorners );
+        for ( int i = 0; i < nbCorners; ++i )
+          _nodes.push_back( face->GetNode( i ));
+      }
+      _faceIt.reset();
+    }
+  };
 
-  MGOutput->GmfCloseMesh( InpMsh);
+  //=======================================================================
+  /*!
+   * \brief Functor gathering faces of TSurfaceChunk's in parallel
+   */
+  //=======================================================================
 
-  // 0022172: [CEA 790] create the groups corresponding to domains
-  if ( toMakeGroupsOfDomains )
-    makeDomainGroups( elemsOfDomain, theHelper );
+  struct TGatherSurface
+  {
+    std::vector< TSurfaceChunk >& _chunks;
 
-#ifdef _MY_DEBUG_
-  std::map<int, std::set<int> >::const_iterator subdomainIt = subdomainId2tetraId.begin();
-  TCollection_AsciiString aSubdomainFileName = theFile;
-  aSubdomainFileName = aSubdomainFileName + ".subdomain";
-  ofstream aSubdomainFile  ( aSubdomainFileName.ToCString()  , ios::out);
+    TGatherSurface( std::vector< TSurfaceChunk >& chunks ): _chunks( chunks ) {}
 
-  aSubdomainFile << "Nb subdomains " << subdomainId2tetraId.size() << std::endl;
-  for(;subdomainIt != subdomainId2tetraId.end() ; ++subdomainIt) {
-    int subdomainId = subdomainIt->first;
-    std::set<int> tetraIds = subdomainIt->second;
-    std::set<int>::const_iterator tetraIdsIt = tetraIds.begin();
-    aSubdomainFile << subdomainId << std::endl;
-    for(;tetraIdsIt != tetraIds.end() ; ++tetraIdsIt) {
-      aSubdomainFile << (*tetraIdsIt) << " ";
+    void operator()( const int iChunk ) const
+    {
+      _chunks[ iChunk ].Gather();
     }
-    aSubdomainFile << std::endl;
-  }
-  aSubdomainFile.close();
-#endif  
-  
-  return true;
+  };
 }
 
-
 static bool writeGMFFile(MG_Tetra_API*                                   MGInput,
                          const char*                                     theMeshFileName,
                          const char*                                     theRequiredFileName,
@@ -1036,37 +2692,35 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
                          SMESH_MesherHelper&                             theHelper,
                          std::vector <const SMDS_MeshNode*> &            theNodeByGhs3dId,
                          std::vector <const SMDS_MeshElement*> &         theFaceByGhs3dId,
-                         std::map<const SMDS_MeshNode*,int> &            aNodeToGhs3dIdMap,
-                         std::vector<std::string> &                      aNodeGroupByGhs3dId,
-                         std::vector<std::string> &                      anEdgeGroupByGhs3dId,
-                         std::vector<std::string> &                      aFaceGroupByGhs3dId,
+                         std::vector<int> &                              aNodeGroupByGhs3dId,
+                         std::vector<int> &                              anEdgeGroupByGhs3dId,
+                         std::vector<int> &                              aFaceGroupByGhs3dId,
+                         TGroupIndex &                                   theGroups,
                          GHS3DPlugin_Hypothesis::TIDSortedNodeGroupMap & theEnforcedNodes,
                          GHS3DPlugin_Hypothesis::TIDSortedElemGroupMap & theEnforcedEdges,
                          GHS3DPlugin_Hypothesis::TIDSortedElemGroupMap & theEnforcedTriangles,
                          std::map<std::vector<double>, std::string> &    enfVerticesWithGroup,
                          GHS3DPlugin_Hypothesis::TGHS3DEnforcedVertexCoordsValues & theEnforcedVertices,
-                         int &                                           theInvalidEnforcedFlags)
+                         int &                                           theInvalidEnforcedFlags,
+                         const bool                                      theToSortNodes)
 {
   std::string tmpStr;
   int idx, idxRequired = 0, idxSol = 0;
-  const int dummyint = 0;
   GHS3DPlugin_Hypothesis::TGHS3DEnforcedVertexCoordsValues::const_iterator vertexIt;
   std::vector<double> enfVertexSizes;
   const SMDS_MeshElement* elem;
-  TIDSortedElemSet anElemSet, theKeptEnforcedEdges, theKeptEnforcedTriangles;
+  TIDSortedElemSet theKeptEnforcedEdges, theKeptEnforcedTriangles;
   SMDS_ElemIteratorPtr nodeIt;
   std::vector <const SMDS_MeshNode*> theEnforcedNodeByGhs3dId;
-  map<const SMDS_MeshNode*,int> anEnforcedNodeToGhs3dIdMap, anExistingEnforcedNodeToGhs3dIdMap;
-  std::vector< const SMDS_MeshElement* > foundElems;
-  map<const SMDS_MeshNode*,TopAbs_State> aNodeToTopAbs_StateMap;
   int nbFoundElems;
   GHS3DPlugin_Hypothesis::TIDSortedElemGroupMap::iterator elemIt;
   TIDSortedElemSet::iterator elemSetIt;
   bool isOK;
   SMESH_Mesh* theMesh = theHelper.GetMesh();
   const bool hasGeom = theMesh->HasShapeToMesh();
-  SMESHUtils::Deleter< SMESH_ElementSearcher > pntCls
-    ( SMESH_MeshAlgos::GetElementSearcher(*theMesh->GetMeshDS()));
+  TNodeToGhs3dIdIndex aNodeToGhs3dIdMap( theMesh->GetMeshDS() ); // MG-Tetra IDs of surface nodes
+  TNodeToGhs3dIdIndex anEnforcedNodeToGhs3dIdMap( theMesh->GetMeshDS() ); // of enforced nodes
+  int nbNewEnforcedNodes = 0;
   
   int nbEnforcedVertices = (int) theEnforcedVertices.size();
   theInvalidEnforcedFlags = 0;
@@ -1083,36 +2737,129 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
   if ( nbFaces == 0 )
     return false;
   
-  idx = MGInput->GmfOpenMesh( theMeshFileName, GmfWrite, GMFVERSION, GMFDIMENSION);
+  // file size: 3 coordinates and a reference per vertex, nodes and a reference per element
+  const double nbVertexBytes = 3 * 8 + 4;
+  const double nbFileBytes = ( nbVertexBytes * ( double( theMesh->NbNodes() ) +
+                                                 theEnforcedNodes.size() + nbEnforcedVertices ) +
+                               4 * 4 * ( double( nbFaces ) + theEnforcedTriangles.size() ) +
+                               3 * 4 * double( theEnforcedEdges.size() ));
+  idx = MGInput->GmfOpenMesh( theMeshFileName, GmfWrite,
+                              MG_Tetra_API::GmfVersion( GMFVERSION, theMeshFileName, nbFileBytes ),
+                              GMFDIMENSION);
   if (!idx)
     return false;
   
   /* ========================== FACES ========================== */
   /* TRIANGLES ========================== */
-  SMDS_ElemIteratorPtr eIt =
-    hasGeom ? theProxyMesh.GetFaces( theHelper.GetSubShape()) : theProxyMesh.GetFaces();
-  while ( eIt->more() )
+  // Faces of each geometrical face are gathered in parallel, then they are
+  // merged in the order of sub-meshes, which numbers nodes in the same order
+  // as a serial iteration over theProxyMesh.GetFaces( shape ) does
+  std::vector< TSurfaceChunk > surfChunks;
+  if ( hasGeom )
   {
-    elem = eIt->next();
-    anElemSet.insert(elem);
-    nodeIt = elem->nodesIterator();
-    nbNodes = elem->NbCornerNodes();
-    while ( nodeIt->more() && nbNodes--)
+    TopTools_IndexedMapOfShape geomFaces;
+    TopExp::MapShapes( theHelper.GetSubShape(), TopAbs_FACE, geomFaces );
+    surfChunks.reserve( geomFaces.Extent() );
+    for ( int iF = 1; iF <= geomFaces.Extent(); ++iF )
+      if ( const SMESHDS_SubMesh* sm = theProxyMesh.GetSubMesh( geomFaces( iF )))
+      {
+        surfChunks.push_back( TSurfaceChunk() );
+        surfChunks.back()._faceIt = sm->GetElements();
+      }
+  }
+  else
+  {
+    surfChunks.resize( 1 );
+    surfChunks.back()._faceIt = theProxyMesh.GetFaces();
+  }
+  OSD_Parallel::For( 0, (int) surfChunks.size(), TGatherSurface( surfChunks ),
+                     /*isForceSingleThreadExecution=*/surfChunks.size() < 2 );
+
+  // offsets of chunks in surfFaces
+  std::vector< size_t > chunkOffset( surfChunks.size() + 1, 0 );
+  for ( size_t iC = 0; iC < surfChunks.size(); ++iC )
+    chunkOffset[ iC + 1 ] = chunkOffset[ iC ] + surfChunks[ iC ]._faces.size();
+
+  std::vector< const SMDS_MeshElement* > surfFaces( chunkOffset.back() );
+  std::vector< int >                     surfTriaNodes; // MG-Tetra IDs of triangle nodes
+  surfTriaNodes.reserve( 3 * surfFaces.size() );
+  for ( size_t iC = 0; iC < surfChunks.size(); ++iC )
+  {
+    TSurfaceChunk& chunk = surfChunks[ iC ];
+    std::copy( chunk._faces.begin(), chunk._faces.end(), surfFaces.begin() + chunkOffset[ iC ]);
+    const SMDS_MeshNode** node = chunk._nodes.data();
+    for ( size_t iF = 0; iF < chunk._nbNodes.size(); ++iF )
     {
-      // find MG-Tetra ID
-      const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-      int newId = (int) aNodeToGhs3dIdMap.size() + 1; // MG-Tetra ids count from 1
-      aNodeToGhs3dIdMap.insert( make_pair( node, newId ));
+      nbNodes = chunk._nbNodes[ iF ];
+      for ( int i = 0; i < nbNodes; ++i, ++node )
+      {
+        // find MG-Tetra ID
+        int newId = (int) aNodeToGhs3dIdMap.Size() + 1; // MG-Tetra ids count from 1
+        if ( aNodeToGhs3dIdMap.Insert( *node, newId ))
+          theNodeByGhs3dId.push_back( *node );
+        if ( i < 3 )
+          surfTriaNodes.push_back( aNodeToGhs3dIdMap.Get( *node ));
+      }
+    }
+    SMESHUtils::FreeVector( chunk._faces );
+    SMESHUtils::FreeVector( chunk._nodes );
+    SMESHUtils::FreeVector( chunk._nbNodes );
+  }
+  SMESHUtils::FreeVector( surfChunks );
+
+  if ( theToSortNodes && theNodeByGhs3dId.size() > 1 )
+  {
+    // renumber surface nodes along a Hilbert curve, so that nodes close in space
+    // are close in memory of MG-Tetra and of readGMFFile()
+    std::vector< gp_XYZ > nodesXYZ( theNodeByGhs3dId.size() );
+    for ( size_t i = 0; i < theNodeByGhs3dId.size(); ++i )
+      nodesXYZ[ i ] = SMESH_TNodeXYZ( theNodeByGhs3dId[ i ]);
+    std::vector< int > order; // old index by new index
+    sortByHilbertCurve( nodesXYZ, order );
+    SMESHUtils::FreeVector( nodesXYZ );
+
+    std::vector< int >                  newIDByOld( order.size() + 1, 0 );
+    std::vector< const SMDS_MeshNode* > nodeByNewID( order.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+      newIDByOld[ order[ i ] + 1 ] = int( i + 1 ); // MG-Tetra ids count from 1
+      nodeByNewID[ i ] = theNodeByGhs3dId[ order[ i ]];
     }
+    theNodeByGhs3dId.swap( nodeByNewID );
+    aNodeToGhs3dIdMap.Renumber( newIDByOld );
+    for ( size_t i = 0; i < surfTriaNodes.size(); ++i )
+      surfTriaNodes[ i ] = newIDByOld[ surfTriaNodes[ i ]];
   }
-  if ( !anElemSet.empty() &&
-       (*anElemSet.begin())->IsQuadratic() &&
+
+  if ( !surfFaces.empty() &&
+       surfFaces[0]->IsQuadratic() &&
        theProxyMesh.NbProxySubMeshes() > 0 )
   {
     // add medium nodes of proxy triangles to theHelper (#16843)
-    for ( elemSetIt = anElemSet.begin(); elemSetIt != anElemSet.end(); ++elemSetIt )
-      theHelper.AddTLinks( static_cast< const SMDS_MeshFace* >( *elemSetIt ));
+    for ( size_t i = 0; i < surfFaces.size(); ++i )
+      theHelper.AddTLinks( static_cast< const SMDS_MeshFace* >( surfFaces[ i ]));
+  }
+
+  /* CLASSIFICATION OF ENFORCED NODES AND VERTICES ========================== */
+
+  TEnforcedPoints enfPoints( theMesh->GetMeshDS() );
+  for(elemIt = theEnforcedEdges.begin() ; elemIt != theEnforcedEdges.end() ; ++elemIt) {
+    for ( int i = 0; i < 2; ++i )
+      enfPoints.AddNode( elemIt->first->GetNode( i ), /*toFindNodes=*/true );
+  }
+  for(elemIt = theEnforcedTriangles.begin() ; elemIt != theEnforcedTriangles.end() ; ++elemIt) {
+    for ( int i = 0; i < 3; ++i )
+      enfPoints.AddNode( elemIt->first->GetNode( i ), /*toFindNodes=*/true );
   }
+  GHS3DPlugin_Hypothesis::TIDSortedNodeGroupMap::const_iterator enfNodeIt;
+  for(enfNodeIt = theEnforcedNodes.begin() ; enfNodeIt != theEnforcedNodes.end() ; ++enfNodeIt)
+    enfPoints.AddNode( enfNodeIt->first, /*toFindNodes=*/false );
+  std::vector< int > enfVertexPointIndex;
+  for ( vertexIt = theEnforcedVertices.begin(); vertexIt != theEnforcedVertices.end(); ++vertexIt )
+    enfVertexPointIndex.push_back( enfPoints.AddPoint( vertexIt->first[0],
+                                                       vertexIt->first[1],
+                                                       vertexIt->first[2] ));
+  enfPoints.Classify();
 
   /* EDGES ========================== */
 
@@ -1126,14 +2873,11 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       // find MG-Tetra ID
       const SMDS_MeshNode* node = castToNode( nodeIt->next() );
       // Test if point is inside shape to mesh
-      gp_Pnt myPoint(node->X(),node->Y(),node->Z());
-      TopAbs_State result = pntCls->GetPointState( myPoint );
-      if ( result == TopAbs_OUT ) {
+      if ( enfPoints.State( enfPoints.Index( node )) == TopAbs_OUT ) {
         isOK = false;
         theInvalidEnforcedFlags |= FLAG_BAD_ENF_EDGE;
         break;
       }
-      aNodeToTopAbs_StateMap.insert( make_pair( node, result ));
     }
     if (isOK) {
       nodeIt = elem->nodesIterator();
@@ -1142,22 +2886,25 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       while ( nodeIt->more() && nbNodes-- ) {
         // find MG-Tetra ID
         const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-        gp_Pnt myPoint(node->X(),node->Y(),node->Z());
-        nbFoundElems = pntCls->FindElementsByPoint(myPoint, SMDSAbs_Node, foundElems);
+        const int iPoint = enfPoints.Index( node );
+        nbFoundElems = enfPoints.NbFoundNodes( iPoint );
 #ifdef _MY_DEBUG_
         std::cout << "Node at "<<node->X()<<", "<<node->Y()<<", "<<node->Z()<<std::endl;
         std::cout << "Nb nodes found : "<<nbFoundElems<<std::endl;
 #endif
         if (nbFoundElems ==0) {
-          if ((*aNodeToTopAbs_StateMap.find(node)).second == TopAbs_IN) {
-            newId = int( aNodeToGhs3dIdMap.size() + anEnforcedNodeToGhs3dIdMap.size() + 1 ); // MG-Tetra ids count from 1
-            anEnforcedNodeToGhs3dIdMap.insert( make_pair( node, newId ));
+          if ( enfPoints.State( iPoint ) == TopAbs_IN ) {
+            newId = int( aNodeToGhs3dIdMap.Size() + nbNewEnforcedNodes + 1 ); // MG-Tetra ids count from 1
+            if ( anEnforcedNodeToGhs3dIdMap.Insert( node, newId )) {
+              theEnforcedNodeByGhs3dId.push_back( node );
+              ++nbNewEnforcedNodes;
+            }
           }
         }
         else if (nbFoundElems ==1) {
-          const SMDS_MeshNode* existingNode = (SMDS_MeshNode*) foundElems.at(0);
-          newId = (*aNodeToGhs3dIdMap.find(existingNode)).second;
-          anExistingEnforcedNodeToGhs3dIdMap.insert( make_pair( node, newId ));
+          const SMDS_MeshNode* existingNode = enfPoints.FoundNode( iPoint );
+          newId = aNodeToGhs3dIdMap.Get( existingNode );
+          anEnforcedNodeToGhs3dIdMap.Insert( node, newId );
         }
         else
           isOK = false;
@@ -1184,14 +2931,11 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       // find MG-Tetra ID
       const SMDS_MeshNode* node = castToNode( nodeIt->next() );
       // Test if point is inside shape to mesh
-      gp_Pnt myPoint(node->X(),node->Y(),node->Z());
-      TopAbs_State result = pntCls->GetPointState( myPoint );
-      if ( result == TopAbs_OUT ) {
+      if ( enfPoints.State( enfPoints.Index( node )) == TopAbs_OUT ) {
         isOK = false;
         theInvalidEnforcedFlags |= FLAG_BAD_ENF_TRIA;
         break;
       }
-      aNodeToTopAbs_StateMap.insert( make_pair( node, result ));
     }
     if (isOK) {
       nodeIt = elem->nodesIterator();
@@ -1200,21 +2944,24 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       while ( nodeIt->more() && nbNodes--) {
         // find MG-Tetra ID
         const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-        gp_Pnt myPoint(node->X(),node->Y(),node->Z());
-        nbFoundElems = pntCls->FindElementsByPoint(myPoint, SMDSAbs_Node, foundElems);
+        const int iPoint = enfPoints.Index( node );
+        nbFoundElems = enfPoints.NbFoundNodes( iPoint );
 #ifdef _MY_DEBUG_
         std::cout << "Nb nodes found : "<<nbFoundElems<<std::endl;
 #endif
         if (nbFoundElems ==0) {
-          if ((*aNodeToTopAbs_StateMap.find(node)).second == TopAbs_IN) {
-            newId = int( aNodeToGhs3dIdMap.size() + anEnforcedNodeToGhs3dIdMap.size() + 1 ); // MG-Tetra ids count from 1
-            anEnforcedNodeToGhs3dIdMap.insert( make_pair( node, newId ));
+          if ( enfPoints.State( iPoint ) == TopAbs_IN ) {
+            newId = int( aNodeToGhs3dIdMap.Size() + nbNewEnforcedNodes + 1 ); // MG-Tetra ids count from 1
+            if ( anEnforcedNodeToGhs3dIdMap.Insert( node, newId )) {
+              theEnforcedNodeByGhs3dId.push_back( node );
+              ++nbNewEnforcedNodes;
+            }
           }
         }
         else if (nbFoundElems ==1) {
-          const SMDS_MeshNode* existingNode = (SMDS_MeshNode*) foundElems.at(0);
-          newId = (*aNodeToGhs3dIdMap.find(existingNode)).second;
-          anExistingEnforcedNodeToGhs3dIdMap.insert( make_pair( node, newId ));
+          const SMDS_MeshNode* existingNode = enfPoints.FoundNode( iPoint );
+          newId = aNodeToGhs3dIdMap.Get( existingNode );
+          anEnforcedNodeToGhs3dIdMap.Insert( node, newId );
         }
         else
           isOK = false;
@@ -1229,35 +2976,22 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
     }
   }
   
-  // put nodes to theNodeByGhs3dId vector
-#ifdef _MY_DEBUG_
-  std::cout << "aNodeToGhs3dIdMap.size(): "<<aNodeToGhs3dIdMap.size()<<std::endl;
-#endif
-  theNodeByGhs3dId.resize( aNodeToGhs3dIdMap.size() );
-  map<const SMDS_MeshNode*,int>::const_iterator n2id = aNodeToGhs3dIdMap.begin();
-  for ( ; n2id != aNodeToGhs3dIdMap.end(); ++ n2id)
-  {
-//     std::cout << "n2id->first: "<<n2id->first<<std::endl;
-    theNodeByGhs3dId[ n2id->second - 1 ] = n2id->first; // MG-Tetra ids count from 1
-  }
-
-  // put nodes to anEnforcedNodeToGhs3dIdMap vector
+  // theNodeByGhs3dId and theEnforcedNodeByGhs3dId are filled in order of MG-Tetra IDs
 #ifdef _MY_DEBUG_
-  std::cout << "anEnforcedNodeToGhs3dIdMap.size(): "<<anEnforcedNodeToGhs3dIdMap.size()<<std::endl;
+  std::cout << "aNodeToGhs3dIdMap.Size(): "<<aNodeToGhs3dIdMap.Size()<<std::endl;
+  std::cout << "nbNewEnforcedNodes: "<<nbNewEnforcedNodes<<std::endl;
 #endif
-  theEnforcedNodeByGhs3dId.resize( anEnforcedNodeToGhs3dIdMap.size());
-  n2id = anEnforcedNodeToGhs3dIdMap.begin();
-  for ( ; n2id != anEnforcedNodeToGhs3dIdMap.end(); ++ n2id)
-  {
-    if (n2id->second > (int)aNodeToGhs3dIdMap.size()) {
-      theEnforcedNodeByGhs3dId[ n2id->second - aNodeToGhs3dIdMap.size() - 1 ] = n2id->first; // MG-Tetra ids count from 1
-    }
-  }
   
   
   /* ========================== NODES ========================== */
   vector<const SMDS_MeshNode*> theOrderedNodes, theRequiredNodes;
-  std::set< std::vector<double> > nodesCoords;
+  const double tolerance = enforcedNodeTolerance();
+  TPointHash nodesCoords( tolerance ); // coordinates of nodes passed to MG-Tetra
+  TPointHash enfVerticesCoords( tolerance );
+  nodesCoords.Reserve( theNodeByGhs3dId.size() + theEnforcedNodeByGhs3dId.size() + theEnforcedNodes.size() );
+  enfVerticesCoords.Reserve( theEnforcedVertices.size() );
+  for ( vertexIt = theEnforcedVertices.begin(); vertexIt != theEnforcedVertices.end(); ++vertexIt )
+    enfVerticesCoords.Add( vertexIt->first[0], vertexIt->first[1], vertexIt->first[2] );
   vector<const SMDS_MeshNode*>::const_iterator ghs3dNodeIt = theNodeByGhs3dId.begin();
   vector<const SMDS_MeshNode*>::const_iterator after  = theNodeByGhs3dId.end();
   
@@ -1266,11 +3000,7 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
   for ( ; ghs3dNodeIt != after; ++ghs3dNodeIt )
   {
     const SMDS_MeshNode* node = *ghs3dNodeIt;
-    std::vector<double> coords;
-    coords.push_back(node->X());
-    coords.push_back(node->Y());
-    coords.push_back(node->Z());
-    nodesCoords.insert(coords);
+    nodesCoords.Add( node->X(), node->Y(), node->Z() );
     theOrderedNodes.push_back(node);
   }
   
@@ -1282,15 +3012,11 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
   for ( ; ghs3dNodeIt != after; ++ghs3dNodeIt )
   {
     const SMDS_MeshNode* node = *ghs3dNodeIt;
-    std::vector<double> coords;
-    coords.push_back(node->X());
-    coords.push_back(node->Y());
-    coords.push_back(node->Z());
 #ifdef _MY_DEBUG_
     std::cout << "Node at " << node->X()<<", " <<node->Y()<<", " <<node->Z();
 #endif
     
-    if (nodesCoords.find(coords) != nodesCoords.end()) {
+    if ( nodesCoords.Contains( node->X(), node->Y(), node->Z() )) {
       // node already exists in original mesh
 #ifdef _MY_DEBUG_
       std::cout << " found" << std::endl;
@@ -1298,7 +3024,7 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       continue;
     }
     
-    if (theEnforcedVertices.find(coords) != theEnforcedVertices.end()) {
+    if ( enfVerticesCoords.Contains( node->X(), node->Y(), node->Z() )) {
       // node already exists in enforced vertices
 #ifdef _MY_DEBUG_
       std::cout << " found" << std::endl;
@@ -1326,31 +3052,24 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
     std::cout << " not found" << std::endl;
 #endif
     
-    nodesCoords.insert(coords);
+    nodesCoords.Add( node->X(), node->Y(), node->Z() );
     theOrderedNodes.push_back(node);
 //     theRequiredNodes.push_back(node);
   }
   
   
   // Iterate over the enforced nodes
-  GHS3DPlugin_Hypothesis::TIDSortedNodeGroupMap::const_iterator enfNodeIt;
   (theEnforcedNodes.size() <= 1) ? tmpStr = " node" : " nodes";
   std::cout << theEnforcedNodes.size() << tmpStr << " from enforced nodes ..." << std::endl;
   for(enfNodeIt = theEnforcedNodes.begin() ; enfNodeIt != theEnforcedNodes.end() ; ++enfNodeIt)
   {
     const SMDS_MeshNode* node = enfNodeIt->first;
-    std::vector<double> coords;
-    coords.push_back(node->X());
-    coords.push_back(node->Y());
-    coords.push_back(node->Z());
 #ifdef _MY_DEBUG_
     std::cout << "Node at " << node->X()<<", " <<node->Y()<<", " <<node->Z();
 #endif
     
     // Test if point is inside shape to mesh
-    gp_Pnt myPoint(node->X(),node->Y(),node->Z());
-    TopAbs_State result = pntCls->GetPointState( myPoint );
-    if ( result == TopAbs_OUT ) {
+    if ( enfPoints.State( enfPoints.Index( node )) == TopAbs_OUT ) {
 #ifdef _MY_DEBUG_
       std::cout << " out of volume" << std::endl;
 #endif
@@ -1358,7 +3077,7 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       continue;
     }
     
-    if (nodesCoords.find(coords) != nodesCoords.end()) {
+    if ( nodesCoords.Contains( node->X(), node->Y(), node->Z() )) {
 #ifdef _MY_DEBUG_
       std::cout << " found in nodesCoords" << std::endl;
 #endif
@@ -1366,7 +3085,7 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       continue;
     }
 
-    if (theEnforcedVertices.find(coords) != theEnforcedVertices.end()) {
+    if ( enfVerticesCoords.Contains( node->X(), node->Y(), node->Z() )) {
 #ifdef _MY_DEBUG_
       std::cout << " found in theEnforcedVertices" << std::endl;
 #endif
@@ -1399,7 +3118,7 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
 #ifdef _MY_DEBUG_
     std::cout << " not found" << std::endl;
 #endif
-    nodesCoords.insert(coords);
+    nodesCoords.Add( node->X(), node->Y(), node->Z() );
 //     theOrderedNodes.push_back(node);
     theRequiredNodes.push_back(node);
   }
@@ -1412,14 +3131,13 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
     (nbEnforcedVertices <= 1) ? tmpStr = " node" : " nodes";
     std::cout << nbEnforcedVertices << tmpStr << " from enforced vertices ..." << std::endl;
     // Iterate over the enforced vertices
-    for(vertexIt = theEnforcedVertices.begin() ; vertexIt != theEnforcedVertices.end() ; ++vertexIt) {
+    int iVertex = 0;
+    for(vertexIt = theEnforcedVertices.begin() ; vertexIt != theEnforcedVertices.end() ; ++vertexIt, ++iVertex) {
       double x = vertexIt->first[0];
       double y = vertexIt->first[1];
       double z = vertexIt->first[2];
       // Test if point is inside shape to mesh
-      gp_Pnt myPoint(x,y,z);
-      TopAbs_State result = pntCls->GetPointState( myPoint );
-      if ( result == TopAbs_OUT )
+      if ( enfPoints.State( enfVertexPointIndex[ iVertex ]) == TopAbs_OUT )
       {
         std::cout << "Warning: enforced vertex at ( " << x << "," << y << "," << z << " ) is out of the meshed domain!!!" << std::endl;
         theInvalidEnforcedFlags |= FLAG_BAD_ENF_VERT;
@@ -1440,35 +3158,45 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
   std::cout << "Begin writting required nodes in GmfVertices" << std::endl;
   std::cout << "Nb vertices: " << theOrderedNodes.size() << std::endl;
   MGInput->GmfSetKwd( idx, GmfVertices, int( theOrderedNodes.size()/*+solSize*/));
-  for (ghs3dNodeIt = theOrderedNodes.begin();ghs3dNodeIt != theOrderedNodes.end();++ghs3dNodeIt) {
-    MGInput->GmfSetLin( idx, GmfVertices, (*ghs3dNodeIt)->X(), (*ghs3dNodeIt)->Y(), (*ghs3dNodeIt)->Z(), dummyint);
-  }
+  // in library mode MG-Tetra reads coordinates of theOrderedNodes
+  MGInput->GmfSetBlock( idx, GmfVertices, std::move( theOrderedNodes ));
 
   std::cout << "End writting required nodes in GmfVertices" << std::endl;
 
   if (requiredNodes + solSize) {
     std::cout << "Begin writting in req and sol file" << std::endl;
     aNodeGroupByGhs3dId.resize( requiredNodes + solSize );
-    idxRequired = MGInput->GmfOpenMesh( theRequiredFileName, GmfWrite, GMFVERSION, GMFDIMENSION);
+    const double nbRequiredBytes = nbVertexBytes * double( requiredNodes + solSize );
+    idxRequired = MGInput->GmfOpenMesh( theRequiredFileName, GmfWrite,
+                                        MG_Tetra_API::GmfVersion( GMFVERSION, theRequiredFileName,
+                                                                  nbRequiredBytes ),
+                                        GMFDIMENSION);
     if (!idxRequired) {
       return false;
     }
-    idxSol = MGInput->GmfOpenMesh( theSolFileName, GmfWrite, GMFVERSION, GMFDIMENSION);
+    idxSol = MGInput->GmfOpenMesh( theSolFileName, GmfWrite,
+                                   MG_Tetra_API::GmfVersion( GMFVERSION, theSolFileName,
+                                                             8. * double( requiredNodes + solSize )),
+                                   GMFDIMENSION);
     if (!idxSol) {
       return false;
     }
     int TypTab[] = {GmfSca};
-    double ValTab[] = {0.0};
     MGInput->GmfSetKwd( idxRequired, GmfVertices, requiredNodes + solSize);
     MGInput->GmfSetKwd( idxSol, GmfSolAtVertices, requiredNodes + solSize, 1, TypTab);
+    std::vector< double > reqXYZ, reqSize;
+    reqXYZ.reserve( 3 * ( requiredNodes + solSize ));
+    reqSize.reserve( requiredNodes + solSize );
 //     int usedEnforcedNodes = 0;
 //     std::string gn = "";
     for (ghs3dNodeIt = theRequiredNodes.begin();ghs3dNodeIt != theRequiredNodes.end();++ghs3dNodeIt) {
-      MGInput->GmfSetLin( idxRequired, GmfVertices, (*ghs3dNodeIt)->X(), (*ghs3dNodeIt)->Y(), (*ghs3dNodeIt)->Z(), dummyint);
-      MGInput->GmfSetLin( idxSol, GmfSolAtVertices, ValTab);
+      reqXYZ.push_back( (*ghs3dNodeIt)->X() );
+      reqXYZ.push_back( (*ghs3dNodeIt)->Y() );
+      reqXYZ.push_back( (*ghs3dNodeIt)->Z() );
+      reqSize.push_back( 0.0 );
       if (theEnforcedNodes.find((*ghs3dNodeIt)) != theEnforcedNodes.end())
         gn = theEnforcedNodes.find((*ghs3dNodeIt))->second;
-      aNodeGroupByGhs3dId[usedEnforcedNodes] = gn;
+      aNodeGroupByGhs3dId[usedEnforcedNodes] = theGroups.Intern( gn );
       usedEnforcedNodes++;
     }
 
@@ -1477,15 +3205,16 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
 #ifdef _MY_DEBUG_
       std::cout << "enfVertexSizes.at("<<i<<"): " << enfVertexSizes.at(i) << std::endl;
 #endif
-      double solTab[] = {enfVertexSizes.at(i)};
-      MGInput->GmfSetLin( idxRequired, GmfVertices, ReqVerTab[i][0], ReqVerTab[i][1], ReqVerTab[i][2], dummyint);
-      MGInput->GmfSetLin( idxSol, GmfSolAtVertices, solTab);
-      aNodeGroupByGhs3dId[usedEnforcedNodes] = enfVerticesWithGroup.find(ReqVerTab[i])->second;
+      reqXYZ.insert( reqXYZ.end(), ReqVerTab[i].begin(), ReqVerTab[i].begin() + 3 );
+      reqSize.push_back( enfVertexSizes.at(i) );
+      aNodeGroupByGhs3dId[usedEnforcedNodes] = theGroups.Intern( enfVerticesWithGroup.find(ReqVerTab[i])->second );
 #ifdef _MY_DEBUG_
-      std::cout << "aNodeGroupByGhs3dId["<<usedEnforcedNodes<<"] = \""<<aNodeGroupByGhs3dId[usedEnforcedNodes]<<"\""<<std::endl;
+      std::cout << "aNodeGroupByGhs3dId["<<usedEnforcedNodes<<"] = "<<aNodeGroupByGhs3dId[usedEnforcedNodes]<<std::endl;
 #endif
       usedEnforcedNodes++;
     }
+    MGInput->GmfSetBlock( idxRequired, GmfVertices,      &reqXYZ[0],  requiredNodes + solSize );
+    MGInput->GmfSetBlock( idxSol,      GmfSolAtVertices, &reqSize[0], requiredNodes + solSize );
     std::cout << "End writting in req and sol file" << std::endl;
   }
 
@@ -1500,6 +3229,8 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
 //      return false;
     MGInput->GmfSetKwd( idx, GmfEdges, (int) theKeptEnforcedEdges.size());
 //    MGInput->GmfSetKwd( idxRequired, GmfEdges, theKeptEnforcedEdges.size());
+    std::vector< int > edgeNodes;
+    edgeNodes.reserve( 2 * theKeptEnforcedEdges.size() );
     for(elemSetIt = theKeptEnforcedEdges.begin() ; elemSetIt != theKeptEnforcedEdges.end() ; ++elemSetIt) {
       elem = (*elemSetIt);
       nodeIt = elem->nodesIterator();
@@ -1507,55 +3238,44 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
       while ( nodeIt->more() ) {
         // find MG-Tetra ID
         const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-        map< const SMDS_MeshNode*,int >::iterator it = anEnforcedNodeToGhs3dIdMap.find(node);
-        if (it == anEnforcedNodeToGhs3dIdMap.end()) {
-          it = anExistingEnforcedNodeToGhs3dIdMap.find(node);
-          if (it == anEnforcedNodeToGhs3dIdMap.end())
-            throw "Node not found";
-        }
-        nedge[index] = it->second;
+        nedge[index] = anEnforcedNodeToGhs3dIdMap.Get( node );
+        if ( nedge[index] < 1 )
+          throw "Node not found";
         index++;
       }
-      MGInput->GmfSetLin( idx, GmfEdges, nedge[0], nedge[1], dummyint);
-      anEdgeGroupByGhs3dId[usedEnforcedEdges] = theEnforcedEdges.find(elem)->second;
+      edgeNodes.push_back( nedge[0] );
+      edgeNodes.push_back( nedge[1] );
+      anEdgeGroupByGhs3dId[usedEnforcedEdges] = theGroups.Intern( theEnforcedEdges.find(elem)->second );
 //      MGInput->GmfSetLin( idxRequired, GmfEdges, nedge[0], nedge[1], dummyint);
       usedEnforcedEdges++;
     }
+    MGInput->GmfSetBlock( idx, GmfEdges, std::move( edgeNodes ), 2 );
   }
 
 
   if (usedEnforcedEdges) {
     MGInput->GmfSetKwd( idx, GmfRequiredEdges, usedEnforcedEdges);
-    for (int enfID=1;enfID<=usedEnforcedEdges;enfID++) {
-      MGInput->GmfSetLin( idx, GmfRequiredEdges, enfID);
-    }
+    std::vector< int > requiredIDs( usedEnforcedEdges );
+    for (int enfID=1;enfID<=usedEnforcedEdges;enfID++)
+      requiredIDs[ enfID-1 ] = enfID;
+    MGInput->GmfSetBlock( idx, GmfRequiredEdges, &requiredIDs[0], 1, usedEnforcedEdges );
   }
 
   // GmfTriangles
   int usedEnforcedTriangles = 0;
-  if (anElemSet.size()+theKeptEnforcedTriangles.size()) {
-    aFaceGroupByGhs3dId.resize( anElemSet.size()+theKeptEnforcedTriangles.size() );
-    MGInput->GmfSetKwd( idx, GmfTriangles, int( anElemSet.size()+theKeptEnforcedTriangles.size() ));
+  if (surfFaces.size()+theKeptEnforcedTriangles.size()) {
+    aFaceGroupByGhs3dId.resize( surfFaces.size()+theKeptEnforcedTriangles.size() );
+    MGInput->GmfSetKwd( idx, GmfTriangles, int( surfFaces.size()+theKeptEnforcedTriangles.size() ));
+    std::vector< int > triaNodes;
+    triaNodes.swap( surfTriaNodes );
+    triaNodes.reserve( 3 * ( surfFaces.size()+theKeptEnforcedTriangles.size() ));
     int k=0;
-    for(elemSetIt = anElemSet.begin() ; elemSetIt != anElemSet.end() ; ++elemSetIt,++k) {
-      elem = (*elemSetIt);
-      theFaceByGhs3dId.push_back( elem );
-      nodeIt = elem->nodesIterator();
-      int index=0;
-      for ( int j = 0; j < 3; ++j ) {
-        // find MG-Tetra ID
-        const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-        map< const SMDS_MeshNode*,int >::iterator it = aNodeToGhs3dIdMap.find(node);
-        if (it == aNodeToGhs3dIdMap.end())
-          throw "Node not found";
-        ntri[index] = it->second;
-        index++;
-      }
-      MGInput->GmfSetLin( idx, GmfTriangles, ntri[0], ntri[1], ntri[2], dummyint);
-      aFaceGroupByGhs3dId[k] = "";
-    }
-    if ( !theHelper.GetMesh()->HasShapeToMesh() )
+    if ( hasGeom )
+      theFaceByGhs3dId.insert( theFaceByGhs3dId.end(), surfFaces.begin(), surfFaces.end() );
+    else
       SMESHUtils::FreeVector( theFaceByGhs3dId );
+    for ( ; k < (int) surfFaces.size(); ++k )
+      aFaceGroupByGhs3dId[k] = 0;
     if (theKeptEnforcedTriangles.size()) {
       for(elemSetIt = theKeptEnforcedTriangles.begin() ; elemSetIt != theKeptEnforcedTriangles.end() ; ++elemSetIt,++k) {
         elem = (*elemSetIt);
@@ -1564,27 +3284,26 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
         for ( int j = 0; j < 3; ++j ) {
           // find MG-Tetra ID
           const SMDS_MeshNode* node = castToNode( nodeIt->next() );
-          map< const SMDS_MeshNode*,int >::iterator it = anEnforcedNodeToGhs3dIdMap.find(node);
-          if (it == anEnforcedNodeToGhs3dIdMap.end()) {
-            it = anExistingEnforcedNodeToGhs3dIdMap.find(node);
-            if (it == anEnforcedNodeToGhs3dIdMap.end())
-              throw "Node not found";
-          }
-          ntri[index] = it->second;
+          ntri[index] = anEnforcedNodeToGhs3dIdMap.Get( node );
+          if ( ntri[index] < 1 )
+            throw "Node not found";
           index++;
         }
-        MGInput->GmfSetLin( idx, GmfTriangles, ntri[0], ntri[1], ntri[2], dummyint);
-        aFaceGroupByGhs3dId[k] = theEnforcedTriangles.find(elem)->second;
+        triaNodes.insert( triaNodes.end(), ntri, ntri + 3 );
+        aFaceGroupByGhs3dId[k] = theGroups.Intern( theEnforcedTriangles.find(elem)->second );
         usedEnforcedTriangles++;
       }
     }
+    MGInput->GmfSetBlock( idx, GmfTriangles, std::move( triaNodes ), 3 );
   }
 
   
   if (usedEnforcedTriangles) {
     MGInput->GmfSetKwd( idx, GmfRequiredTriangles, usedEnforcedTriangles);
+    std::vector< int > requiredIDs( usedEnforcedTriangles );
     for (int enfID=1;enfID<=usedEnforcedTriangles;enfID++)
-      MGInput->GmfSetLin( idx, GmfRequiredTriangles, int( anElemSet.size()+enfID ));
+      requiredIDs[ enfID-1 ] = int( surfFaces.size()+enfID );
+    MGInput->GmfSetBlock( idx, GmfRequiredTriangles, &requiredIDs[0], 1, usedEnforcedTriangles );
   }
 
   // close input files and change results files permissions to user only
@@ -1605,6 +3324,24 @@ static bool writeGMFFile(MG_Tetra_API*                                   MGInput
 }
 
 
+namespace
+{
+  // SMESH_Gen keeps the cancellation flag and the current sub-mesh for all its
+  // meshes, so it can compute one mesh at a time only. A generator is busy from
+  // StartCompute() till WaitCompute() returns
+  std::mutex                              theAsyncGenMutex;
+  std::map< SMESH_Gen*, std::thread::id > theAsyncGens; // generator -> thread computing with it
+
+  //! Check if a generator is busy with an asynchronous computation of another thread
+  bool isComputedAsyncByOtherThread( SMESH_Gen* gen )
+  {
+    std::lock_guard< std::mutex > genLock( theAsyncGenMutex );
+    std::map< SMESH_Gen*, std::thread::id >::const_iterator gen2thread = theAsyncGens.find( gen );
+    return ( gen2thread != theAsyncGens.end() &&
+             gen2thread->second != std::this_thread::get_id() );
+  }
+}
+
 //=============================================================================
 /*!
  *Here we are going to use the MG-Tetra mesher with geometry
@@ -1616,6 +3353,16 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   bool Ok(false);
   TopExp_Explorer expBox ( theShape, TopAbs_SOLID );
 
+  if ( isComputedAsyncByOtherThread( _gen ))
+    return error( COMPERR_ALGO_FAILED, "Another mesh is being computed by StartCompute()" );
+
+  if ( !MG_Tetra_API::CanExchange( theMesh.NbNodes() ) ||
+       !MG_Tetra_API::CanExchange( theMesh.NbFaces() ))
+    return error( COMPERR_BAD_INPUT_MESH, "Too many nodes or faces to be passed to MG-Tetra" );
+
+  if ( canComputeSolidsConcurrently( theMesh, theShape ))
+    return computeSolidsConcurrently( theMesh, theShape );
+
   // a unique working file name
   // to avoid access to the same files by eg different users
   _genericName = GHS3DPlugin_Hypothesis::GetFileName(_hyp);
@@ -1625,12 +3372,16 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   TCollection_AsciiString aLogFileName    = aGenericName + ".log";    // log
   TCollection_AsciiString aResultFileName;
 
+  // ASCII or binary GMF files
+  const TCollection_AsciiString meshExt = GHS3DPlugin_Hypothesis::MeshFileExtension( _hyp ).c_str();
+  const TCollection_AsciiString solExt  = GHS3DPlugin_Hypothesis::SolFileExtension ( _hyp ).c_str();
+
   TCollection_AsciiString aGMFFileName, aRequiredVerticesFileName, aSolFileName, aResSolFileName;
-  aGMFFileName              = aGenericName + ".mesh"; // GMF mesh file
-  aResultFileName           = aGenericName + "Vol.mesh"; // GMF mesh file
-  aResSolFileName           = aGenericName + "Vol.sol"; // GMF mesh file
-  aRequiredVerticesFileName = aGenericNameRequired + ".mesh"; // GMF required vertices mesh file
-  aSolFileName              = aGenericNameRequired + ".sol"; // GMF solution file
+  aGMFFileName              = aGenericName + meshExt; // GMF mesh file
+  aResultFileName           = aGenericName + "Vol" + meshExt; // GMF mesh file
+  aResSolFileName           = aGenericName + "Vol" + solExt; // GMF mesh file
+  aRequiredVerticesFileName = aGenericNameRequired + meshExt; // GMF required vertices mesh file
+  aSolFileName              = aGenericNameRequired + solExt; // GMF solution file
   
   std::map <int,int> aNodeId2NodeIndexMap, aSmdsToGhs3dIdMap, anEnforcedNodeIdToGhs3dIdMap;
   std::map <int, int> nodeID2nodeIndexMap;
@@ -1683,12 +3434,11 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
 
   std::vector <const SMDS_MeshNode*> aNodeByGhs3dId, anEnforcedNodeByGhs3dId;
   std::vector <const SMDS_MeshElement*> aFaceByGhs3dId;
-  std::map<const SMDS_MeshNode*,int> aNodeToGhs3dIdMap;
-  std::vector<std::string> aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId;
+  std::vector<int> aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId;
+  TGroupIndex      groupIndex;
 
   MG_Tetra_API mgTetra( _computeCanceled, _progress );
 
-  _isLibUsed = mgTetra.IsLibrary();
   if ( theMesh.NbQuadrangles() > 0 )
     _progressAdvance /= 10;
   if ( _viscousLayersHyp )
@@ -1731,16 +3481,19 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   //     return false;
   // }
 
+  setComputeState( COMPUTE_WRITING_INPUT );
+
   int anInvalidEnforcedFlags = 0;
   Ok = writeGMFFile(&mgTetra,
                     aGMFFileName.ToCString(),
                     aRequiredVerticesFileName.ToCString(),
                     aSolFileName.ToCString(),
                     *proxyMesh, helper,
-                    aNodeByGhs3dId, aFaceByGhs3dId, aNodeToGhs3dIdMap,
-                    aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId,
+                    aNodeByGhs3dId, aFaceByGhs3dId,
+                    aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
                     enforcedNodes, enforcedEdges, enforcedTriangles,
-                    enfVerticesWithGroup, coordsSizeMap, anInvalidEnforcedFlags);
+                    enfVerticesWithGroup, coordsSizeMap, anInvalidEnforcedFlags,
+                    GHS3DPlugin_Hypothesis::GetToSortInputNodes( _hyp ));
 
   // Write aSmdsToGhs3dIdMap to temp file
   TCollection_AsciiString aSmdsToGhs3dIdMapFileName;
@@ -1795,7 +3548,7 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   std::cout << "MG-Tetra execution..." << std::endl;
   std::cout << cmd << std::endl;
 
-  _computeCanceled = false;
+  setComputeState( COMPUTE_MESHING );
 
   std::string errStr;
   Ok = mgTetra.Compute( cmd.ToCString(), errStr ); // run
@@ -1823,7 +3576,8 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   // read a result
   // --------------
 
-  GHS3DPlugin_Hypothesis::TSetStrings groupsToRemove = GHS3DPlugin_Hypothesis::GetGroupsToRemove(_hyp);
+  setComputeState( COMPUTE_READING_OUTPUT );
+
   bool toMeshHoles =
     _hyp ? _hyp->GetToMeshHoles(true) : GHS3DPlugin_Hypothesis::DefaultMeshHoles();
   const bool toMakeGroupsOfDomains = GHS3DPlugin_Hypothesis::GetToMakeGroupsOfDomains( _hyp );
@@ -1831,12 +3585,14 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   helper.IsQuadraticSubMesh( theShape );
   helper.SetElementsOnShape( false );
 
+  std::string readErrStr;
   Ok = readGMFFile(&mgTetra,
                    aResultFileName.ToCString(),
                    this,
-                   &helper, aNodeByGhs3dId, aFaceByGhs3dId, aNodeToGhs3dIdMap,
-                   aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId,
-                   groupsToRemove, toMakeGroupsOfDomains, toMeshHoles);
+                   &helper, aNodeByGhs3dId, aFaceByGhs3dId,
+                   aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
+                   readErrStr, toMakeGroupsOfDomains, toMeshHoles,
+                   GHS3DPlugin_Hypothesis::GetToRenumberResult( _hyp ));
 
   removeEmptyGroupsOfDomains( helper.GetMesh(), /*notEmptyAsWell =*/ !toMakeGroupsOfDomains );
 
@@ -1855,6 +3611,10 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
     // if ( _hyp && _hyp->GetToMakeGroupsOfDomains() )
     //   error( COMPERR_WARNING, "'toMakeGroupsOfDomains' is ignored since the mesh is on shape" );
   }
+  else if ( !readErrStr.empty() )
+  {
+    error( COMPERR_ALGO_FAILED, readErrStr );
+  }
   else if ( mgTetra.HasLog() )
   {
     if( _computeCanceled )
@@ -1900,6 +3660,314 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   return Ok;
 }
 
+//================================================================================
+/*!
+ * \brief Data of a MG-Tetra run meshing one solid
+ */
+//================================================================================
+
+struct GHS3DPlugin_GHS3D::TSolidRun
+{
+  TopoDS_Shape                          _solid;
+  std::string                           _genericName;
+  std::unique_ptr< SMESH_MesherHelper > _helper;
+  double                                _progress;
+  SMESH_ComputeErrorPtr                 _error;
+};
+
+//================================================================================
+/*!
+ * \brief MG-Tetra runs meshing solids of a shape, shared by threads executing them
+ */
+//================================================================================
+
+struct GHS3DPlugin_GHS3D::TSolidRuns
+{
+  std::vector< TSolidRun > _runs;
+  std::atomic< int >       _nextRun;
+  std::atomic< int >       _nbFailed;
+  int                      _nbDone;
+  std::mutex               _meshMutex; // SMESHDS_Mesh is accessed by one thread at a time
+
+  TSolidRuns(): _nextRun( 0 ), _nbFailed( 0 ), _nbDone( 0 ) {}
+};
+
+//================================================================================
+/*!
+ * \brief Check if solids of theShape are to be meshed by concurrent MG-Tetra runs.
+ *
+ * Enforced vertices and meshes, viscous layers and quadrangles, which need
+ * data common to all solids, are supported by a single run only. So are
+ * groups of domains, as each run numbers its domains from one.
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::canComputeSolidsConcurrently( SMESH_Mesh&         theMesh,
+                                                      const TopoDS_Shape& theShape ) const
+{
+  if ( !GHS3DPlugin_Hypothesis::GetToMeshSolidsConcurrently( _hyp ) ||
+       GHS3DPlugin_Hypothesis::GetToMakeGroupsOfDomains( _hyp ) ||
+       _viscousLayersHyp ||
+       theMesh.NbQuadrangles() > 0 )
+    return false;
+
+  if ( !GHS3DPlugin_Hypothesis::GetEnforcedVertices( _hyp ).empty() ||
+       !GHS3DPlugin_Hypothesis::GetEnforcedVerticesCoordsSize( _hyp ).empty() ||
+       !GHS3DPlugin_Hypothesis::GetEnforcedNodes( _hyp ).empty() ||
+       !GHS3DPlugin_Hypothesis::GetEnforcedEdges( _hyp ).empty() ||
+       !GHS3DPlugin_Hypothesis::GetEnforcedTriangles( _hyp ).empty() )
+    return false;
+
+  TopExp_Explorer solid( theShape, TopAbs_SOLID );
+  if ( !solid.More() )
+    return false;
+  solid.Next();
+  return solid.More();
+}
+
+//================================================================================
+/*!
+ * \brief Mesh each solid of theShape by a separate MG-Tetra run.
+ *
+ * Surface meshes of solids are written and MG-Tetra runs concurrently, as
+ * many runs at a time as allows a thread budget, which is the number of
+ * processor cores or MG_TETRA_THREAD_BUDGET environment variable value,
+ * see MG_Tetra_Budget.
+ * Results are imported by one run at a time. Faces shared by solids are
+ * already meshed and MG-Tetra does not modify them, so volumes of solids
+ * are conformal.
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::computeSolidsConcurrently( SMESH_Mesh&         theMesh,
+                                                   const TopoDS_Shape& theShape )
+{
+  _genericName = GHS3DPlugin_Hypothesis::GetFileName(_hyp);
+
+  TSolidRuns runs;
+  TopTools_IndexedMapOfShape solids;
+  TopExp::MapShapes( theShape, TopAbs_SOLID, solids );
+  runs._runs.resize( solids.Extent() );
+  for ( int i = 1; i <= solids.Extent(); ++i )
+  {
+    TSolidRun& run   = runs._runs[ i - 1 ];
+    run._solid       = solids( i );
+    run._genericName = SMESH_Comment( _genericName ) << "_" << i;
+    run._progress    = 0;
+    run._helper.reset( new SMESH_MesherHelper( theMesh ));
+    run._helper->SetSubShape( run._solid );
+    run._helper->IsQuadraticSubMesh( run._solid );
+    run._helper->SetElementsOnShape( false );
+  }
+
+  // number of concurrent runs
+  int nbThreadsPerRun = GHS3DPlugin_Hypothesis::DefaultNumOfThreads();
+  if ( _hyp && _hyp->GetUseNumOfThreads() )
+    nbThreadsPerRun = _hyp->GetNumOfThreads();
+  const int threadBudget = MG_Tetra_Budget::TotalThreads();
+  const int nbWorkers = std::max( 1, std::min( threadBudget / std::max( 1, nbThreadsPerRun ),
+                                               solids.Extent() ));
+
+  std::cout << "MG-Tetra meshes " << solids.Extent() << " solids by "
+            << nbWorkers << " concurrent runs" << std::endl;
+
+  setComputeState( COMPUTE_MESHING );
+
+  std::vector< std::thread > workers;
+  for ( int i = 1; i < nbWorkers; ++i )
+    workers.push_back( std::thread( &GHS3DPlugin_GHS3D::computeSolids, this, &runs ));
+  computeSolids( &runs );
+  for ( size_t i = 0; i < workers.size(); ++i )
+    workers[i].join();
+
+  // no groups of domains, see canComputeSolidsConcurrently()
+  removeEmptyGroupsOfDomains( &theMesh, /*notEmptyAsWell =*/ true );
+
+  if ( _computeCanceled )
+    return error( "interruption initiated by user" );
+
+  for ( size_t i = 0; i < runs._runs.size(); ++i )
+    if ( runs._runs[i]._error && !runs._runs[i]._error->IsOK() )
+      return error( runs._runs[i]._error );
+
+  if ( runs._nbFailed > 0 )
+    return error( COMPERR_ALGO_FAILED );
+
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Execute MG-Tetra runs one by one until all are taken by threads
+ */
+//================================================================================
+
+void GHS3DPlugin_GHS3D::computeSolids( TSolidRuns* theRuns )
+{
+  for ( int i = theRuns->_nextRun++; i < (int) theRuns->_runs.size(); i = theRuns->_nextRun++ )
+  {
+    if ( _computeCanceled || theRuns->_nbFailed > 0 )
+      break;
+    TSolidRun& run = theRuns->_runs[ i ];
+    bool ok = false;
+    try // an exception must not leave a worker thread
+    {
+      ok = computeSolid( *theRuns, run );
+    }
+    catch ( std::exception& exc )
+    {
+      run._error = SMESH_ComputeError::New( COMPERR_STD_EXCEPTION, exc.what(), this );
+    }
+    catch ( ... )
+    {
+      run._error = SMESH_ComputeError::New( COMPERR_EXCEPTION, "", this );
+    }
+    if ( !ok )
+      ++theRuns->_nbFailed;
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Mesh one solid by MG-Tetra
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::computeSolid( TSolidRuns& theRuns, TSolidRun& theRun )
+{
+  SMESH_MesherHelper& helper = *theRun._helper;
+
+  TCollection_AsciiString aGenericName = theRun._genericName.c_str();
+  TCollection_AsciiString aGenericNameRequired = aGenericName + "_required";
+
+  const TCollection_AsciiString meshExt = GHS3DPlugin_Hypothesis::MeshFileExtension( _hyp ).c_str();
+  const TCollection_AsciiString solExt  = GHS3DPlugin_Hypothesis::SolFileExtension ( _hyp ).c_str();
+
+  TCollection_AsciiString aLogFileName              = aGenericName + ".log";
+  TCollection_AsciiString aGMFFileName              = aGenericName + meshExt;
+  TCollection_AsciiString aResultFileName           = aGenericName + "Vol" + meshExt;
+  TCollection_AsciiString aResSolFileName           = aGenericName + "Vol" + solExt;
+  TCollection_AsciiString aRequiredVerticesFileName = aGenericNameRequired + meshExt;
+  TCollection_AsciiString aSolFileName              = aGenericNameRequired + solExt;
+
+  // no enforced entities, see canComputeSolidsConcurrently()
+  GHS3DPlugin_Hypothesis::TIDSortedNodeGroupMap enforcedNodes;
+  GHS3DPlugin_Hypothesis::TIDSortedElemGroupMap enforcedEdges, enforcedTriangles;
+  GHS3DPlugin_Hypothesis::TGHS3DEnforcedVertexCoordsValues coordsSizeMap;
+  std::map<std::vector<double>, std::string> enfVerticesWithGroup;
+
+  std::vector <const SMDS_MeshNode*> aNodeByGhs3dId;
+  std::vector <const SMDS_MeshElement*> aFaceByGhs3dId;
+  std::vector<int> aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId;
+  TGroupIndex      groupIndex;
+
+  MG_Tetra_API mgTetra( _computeCanceled, theRun._progress );
+
+  SMESH_ProxyMesh::Ptr proxyMesh( new SMESH_ProxyMesh( *helper.GetMesh() ));
+
+  // the mesh is read while other runs import their results
+  int anInvalidEnforcedFlags = 0;
+  bool Ok;
+  {
+    std::lock_guard< std::mutex > lock( theRuns._meshMutex );
+    Ok = writeGMFFile(&mgTetra,
+                      aGMFFileName.ToCString(),
+                      aRequiredVerticesFileName.ToCString(),
+                      aSolFileName.ToCString(),
+                      *proxyMesh, helper,
+                      aNodeByGhs3dId, aFaceByGhs3dId,
+                      aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
+                      enforcedNodes, enforcedEdges, enforcedTriangles,
+                      enfVerticesWithGroup, coordsSizeMap, anInvalidEnforcedFlags,
+                      GHS3DPlugin_Hypothesis::GetToSortInputNodes( _hyp ));
+  }
+  if ( !Ok )
+  {
+    if ( !_keepFiles )
+      removeFile( aGMFFileName );
+    theRun._error = SMESH_ComputeError::New( COMPERR_BAD_INPUT_MESH, "", this );
+    return false;
+  }
+  removeFile( aResultFileName );
+
+  // run MG-Tetra mesher
+
+  TCollection_AsciiString cmd = GHS3DPlugin_Hypothesis::CommandToRun( _hyp, true, mgTetra.IsExecutable() ).c_str();
+  if ( mgTetra.IsExecutable() )
+  {
+    cmd += TCollection_AsciiString(" --in ") + aGMFFileName;
+    cmd += TCollection_AsciiString(" --out ") + aResultFileName;
+  }
+  if ( !_logInStandardOutput )
+  {
+    mgTetra.SetLogFile( aLogFileName.ToCString() );
+    cmd += TCollection_AsciiString(" 1>" ) + aLogFileName;  // dump into file
+  }
+
+  std::string errStr;
+  Ok = mgTetra.Compute( cmd.ToCString(), errStr ); // run
+
+  chmodUserOnly(aLogFileName.ToCString());
+  if ( Ok )
+    chmodUserOnly(aResultFileName.ToCString());
+
+  // read a result
+
+  {
+    std::lock_guard< std::mutex > lock( theRuns._meshMutex );
+
+    bool toMeshHoles =
+      _hyp ? _hyp->GetToMeshHoles(true) : GHS3DPlugin_Hypothesis::DefaultMeshHoles();
+
+    std::string readErrStr;
+    Ok = Ok && readGMFFile(&mgTetra,
+                           aResultFileName.ToCString(),
+                           this,
+                           &helper, aNodeByGhs3dId, aFaceByGhs3dId,
+                           aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
+                           readErrStr, /*toMakeGroupsOfDomains=*/false, toMeshHoles,
+                           GHS3DPlugin_Hypothesis::GetToRenumberResult( _hyp ));
+
+    if ( Ok )
+    {
+      if ( _removeLogOnSuccess )
+        removeFile( aLogFileName );
+    }
+    else if ( _computeCanceled )
+    {
+      // reported by computeSolidsConcurrently()
+    }
+    else if ( !readErrStr.empty() )
+    {
+      theRun._error = SMESH_ComputeError::New( COMPERR_ALGO_FAILED, readErrStr, this );
+    }
+    else if ( mgTetra.HasLog() )
+    {
+      // get problem description from the log file
+      _Ghs2smdsConvertor conv( aNodeByGhs3dId, proxyMesh );
+      theRun._error = getErrorDescription( _logInStandardOutput ? 0 : aLogFileName.ToCString(),
+                                           mgTetra.GetLog(), conv );
+    }
+    else
+    {
+      removeFile( aLogFileName );
+      theRun._error = SMESH_ComputeError::New( COMPERR_ALGO_FAILED, errStr, this );
+    }
+
+    _progress = std::max( _progress, double( ++theRuns._nbDone ) / (double) theRuns._runs.size() );
+  }
+
+  if ( !_keepFiles )
+  {
+    if ( !Ok && _computeCanceled )
+      removeFile( aLogFileName );
+    removeFile( aGMFFileName );
+    removeFile( aResSolFileName );
+    removeFile( aResultFileName );
+  }
+  return Ok;
+}
+
 //=============================================================================
 /*!
  *Here we are going to use the MG-Tetra mesher w/o geometry
@@ -1911,6 +3979,13 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
 {
   theHelper->IsQuadraticSubMesh( theHelper->GetSubShape() );
 
+  if ( isComputedAsyncByOtherThread( _gen ))
+    return error( COMPERR_ALGO_FAILED, "Another mesh is being computed by StartCompute()" );
+
+  if ( !MG_Tetra_API::CanExchange( theMesh.NbNodes() ) ||
+       !MG_Tetra_API::CanExchange( theMesh.NbFaces() ))
+    return error( COMPERR_BAD_INPUT_MESH, "Too many nodes or faces to be passed to MG-Tetra" );
+
   // a unique working file name
   // to avoid access to the same files by eg different users
   _genericName = GHS3DPlugin_Hypothesis::GetFileName(_hyp);
@@ -1921,12 +3996,16 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   TCollection_AsciiString aResultFileName;
   bool Ok;
 
+  // ASCII or binary GMF files
+  const TCollection_AsciiString meshExt = GHS3DPlugin_Hypothesis::MeshFileExtension( _hyp ).c_str();
+  const TCollection_AsciiString solExt  = GHS3DPlugin_Hypothesis::SolFileExtension ( _hyp ).c_str();
+
   TCollection_AsciiString aGMFFileName, aRequiredVerticesFileName, aSolFileName, aResSolFileName;
-  aGMFFileName              = aGenericName + ".mesh"; // GMF mesh file
-  aResultFileName           = aGenericName + "Vol.mesh"; // GMF mesh file
-  aResSolFileName           = aGenericName + "Vol.sol"; // GMF mesh file
-  aRequiredVerticesFileName = aGenericNameRequired + ".mesh"; // GMF required vertices mesh file
-  aSolFileName              = aGenericNameRequired + ".sol"; // GMF solution file
+  aGMFFileName              = aGenericName + meshExt; // GMF mesh file
+  aResultFileName           = aGenericName + "Vol" + meshExt; // GMF mesh file
+  aResSolFileName           = aGenericName + "Vol" + solExt; // GMF mesh file
+  aRequiredVerticesFileName = aGenericNameRequired + meshExt; // GMF required vertices mesh file
+  aSolFileName              = aGenericNameRequired + solExt; // GMF solution file
 
   std::map <int, int> nodeID2nodeIndexMap;
   std::map<std::vector<double>, std::string> enfVerticesWithGroup;
@@ -1980,13 +4059,12 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
 
   std::vector <const SMDS_MeshNode*> aNodeByGhs3dId, anEnforcedNodeByGhs3dId;
   std::vector <const SMDS_MeshElement*> aFaceByGhs3dId;
-  std::map<const SMDS_MeshNode*,int> aNodeToGhs3dIdMap;
-  std::vector<std::string> aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId;
+  std::vector<int> aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId;
+  TGroupIndex      groupIndex;
 
 
   MG_Tetra_API mgTetra( _computeCanceled, _progress );
 
-  _isLibUsed = mgTetra.IsLibrary();
   if ( theMesh.NbQuadrangles() > 0 )
     _progressAdvance /= 10;
 
@@ -2002,14 +4080,17 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
       return false;
   }
 
+  setComputeState( COMPUTE_WRITING_INPUT );
+
   int anInvalidEnforcedFlags = 0;
   Ok = writeGMFFile(&mgTetra,
                     aGMFFileName.ToCString(), aRequiredVerticesFileName.ToCString(), aSolFileName.ToCString(),
                     *proxyMesh, *theHelper,
-                    aNodeByGhs3dId, aFaceByGhs3dId, aNodeToGhs3dIdMap,
-                    aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId,
+                    aNodeByGhs3dId, aFaceByGhs3dId,
+                    aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
                     enforcedNodes, enforcedEdges, enforcedTriangles,
-                    enfVerticesWithGroup, coordsSizeMap, anInvalidEnforcedFlags);
+                    enfVerticesWithGroup, coordsSizeMap, anInvalidEnforcedFlags,
+                    GHS3DPlugin_Hypothesis::GetToSortInputNodes( _hyp ));
 
   // -----------------
   // run MG-Tetra mesher
@@ -2034,7 +4115,7 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   std::cout << "MG-Tetra execution..." << std::endl;
   std::cout << cmd << std::endl;
 
-  _computeCanceled = false;
+  setComputeState( COMPUTE_MESHING );
 
   std::string errStr;
   Ok = mgTetra.Compute( cmd.ToCString(), errStr ); // run
@@ -2053,15 +4134,19 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   // --------------
   // read a result
   // --------------
+
+  setComputeState( COMPUTE_READING_OUTPUT );
   GHS3DPlugin_Hypothesis::TSetStrings groupsToRemove = GHS3DPlugin_Hypothesis::GetGroupsToRemove(_hyp);
   const bool toMakeGroupsOfDomains = GHS3DPlugin_Hypothesis::GetToMakeGroupsOfDomains( _hyp );
 
+  std::string readErrStr;
   Ok = Ok && readGMFFile(&mgTetra,
                          aResultFileName.ToCString(),
                          this,
-                         theHelper, aNodeByGhs3dId, aFaceByGhs3dId, aNodeToGhs3dIdMap,
-                         aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId,
-                         groupsToRemove, toMakeGroupsOfDomains);
+                         theHelper, aNodeByGhs3dId, aFaceByGhs3dId,
+                         aNodeGroupByGhs3dId, anEdgeGroupByGhs3dId, aFaceGroupByGhs3dId, groupIndex,
+                         readErrStr, toMakeGroupsOfDomains, /*toMeshHoles=*/true,
+                         GHS3DPlugin_Hypothesis::GetToRenumberResult( _hyp ));
 
   updateMeshGroups(theHelper->GetMesh(), groupsToRemove);
   removeEmptyGroupsOfDomains( theHelper->GetMesh(), /*notEmptyAsWell =*/ !toMakeGroupsOfDomains );
@@ -2085,6 +4170,10 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
     //if ( !toMakeGroupsOfDomains && _hyp && _hyp->GetToMakeGroupsOfDomains() )
     //error( COMPERR_WARNING, "'toMakeGroupsOfDomains' is ignored since 'toMeshHoles' is OFF." );
   }
+  else if ( !readErrStr.empty() )
+  {
+    error( COMPERR_ALGO_FAILED, readErrStr );
+  }
   else if ( mgTetra.HasLog() )
   {
     if( _computeCanceled )
@@ -2117,15 +4206,181 @@ bool GHS3DPlugin_GHS3D::Compute(SMESH_Mesh&         theMesh,
   return Ok;
 }
 
+//================================================================================
+/*!
+ * \brief Terminate a process. MG-Tetra executable is terminated by MG_Tetra_API
+ *        which watches the flag
+ */
+//================================================================================
+
 void GHS3DPlugin_GHS3D::CancelCompute()
 {
   _computeCanceled = true;
-#if !defined WIN32 && !defined __APPLE__
-  std::string cmd = "ps xo pid,args | grep " + _genericName;
-  //cmd += " | grep -e \"^ *[0-9]\\+ \\+" + GHS3DPlugin_Hypothesis::GetExeName() + "\"";
-  cmd += " | awk '{print $1}' | xargs kill -9 > /dev/null 2>&1";
-  system( cmd.c_str() );
-#endif
+}
+
+//================================================================================
+/*!
+ * \brief Start computing a mesh in a separate thread. Other algorithms assigned
+ *        to the mesh are run as well, as by SMESH_Gen::Compute(). Until
+ *        WaitCompute() returns, MG-Tetra refuses to compute other meshes of
+ *        the same SMESH_Gen
+ *  \return bool - false if a previous computation is not finished yet or if
+ *          another mesh of the same SMESH_Gen is being computed asynchronously
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::StartCompute( SMESH_Mesh& theMesh )
+{
+  std::lock_guard< std::mutex > lock( _computeMutex );
+  if ( isComputing() )
+    return false;
+  joinComputeThread(); // WaitCompute() was not called
+
+  std::lock_guard< std::mutex > genLock( theAsyncGenMutex );
+  if ( theAsyncGens.count( _gen ))
+    return false;
+
+  _asyncMesh       = &theMesh;
+  _computeState    = COMPUTE_PREPARING;
+  _isAsyncCanceled = false;
+  _gen->PrepareCompute( theMesh, theMesh.GetShapeToMesh() );
+
+  // the thread waits for theAsyncGenMutex before checking theAsyncGens in Compute()
+  _computeThread = std::thread( &GHS3DPlugin_GHS3D::computeAsync, this );
+  theAsyncGens[ _gen ] = _computeThread.get_id();
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Wait for the end of a computation started by StartCompute()
+ *  \param [in] theTimeout - max time to wait in seconds; negative means no limit
+ *  \return bool - true if the computation is finished
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::WaitCompute( double theTimeout )
+{
+  std::unique_lock< std::mutex > lock( _computeMutex );
+
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast< std::chrono::steady_clock::duration >
+    ( std::chrono::duration< double >( std::max( 0., theTimeout )));
+
+  while ( isComputing() )
+  {
+    if ( theTimeout < 0 )
+      _computeEnd.wait( lock );
+    else if ( _computeEnd.wait_until( lock, deadline ) == std::cv_status::timeout )
+      break;
+  }
+  if ( isComputing() )
+    return false;
+
+  joinComputeThread();
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Join the thread of a finished computation and free its SMESH_Gen
+ */
+//================================================================================
+
+void GHS3DPlugin_GHS3D::joinComputeThread()
+{
+  if ( !_computeThread.joinable() )
+    return;
+  _computeThread.join();
+
+  std::lock_guard< std::mutex > genLock( theAsyncGenMutex );
+  theAsyncGens.erase( _gen );
+}
+
+//================================================================================
+/*!
+ * \brief Cancel a computation started by StartCompute()
+ */
+//================================================================================
+
+void GHS3DPlugin_GHS3D::CancelAsyncCompute()
+{
+  std::lock_guard< std::mutex > lock( _computeMutex );
+  if ( !isComputing() )
+    return;
+
+  _isAsyncCanceled = true;
+  _gen->CancelCompute( *_asyncMesh, _asyncMesh->GetShapeToMesh() ); // stop other algorithms
+  CancelCompute();
+}
+
+//================================================================================
+/*!
+ * \brief Check if a computation started by StartCompute() is not finished
+ */
+//================================================================================
+
+bool GHS3DPlugin_GHS3D::isComputing() const
+{
+  const TComputeState state = _computeState;
+  return ( state != COMPUTE_NOT_STARTED && state < COMPUTE_DONE );
+}
+
+//================================================================================
+/*!
+ * \brief Advance the stage of a computation started by StartCompute()
+ */
+//================================================================================
+
+void GHS3DPlugin_GHS3D::setComputeState( TComputeState state )
+{
+  if ( isComputing() )
+    _computeState = state;
+}
+
+//================================================================================
+/*!
+ * \brief Compute the mesh given to StartCompute(). Run in a separate thread
+ */
+//================================================================================
+
+void GHS3DPlugin_GHS3D::computeAsync()
+{
+  bool ok = false;
+  std::string errText;
+  try
+  {
+    ok = _gen->Compute( *_asyncMesh, _asyncMesh->GetShapeToMesh() );
+  }
+  catch ( Standard_Failure& exc )
+  {
+    errText = SMESH_Comment("OCC exception: ") << exc.GetMessageString();
+  }
+  catch ( std::exception& exc )
+  {
+    errText = exc.what();
+  }
+  catch ( ... )
+  {
+    errText = "unknown exception";
+  }
+  if ( !errText.empty() )
+  {
+    // report the exception as a compute error of the algorithm and of the mesh
+    ok = false;
+    error( COMPERR_EXCEPTION, errText );
+    SMESH_subMesh* mainSM = _asyncMesh->GetSubMesh( _asyncMesh->GetShapeToMesh() );
+    SMESH_ComputeErrorPtr& mainError = mainSM->GetComputeError();
+    if ( !mainError || mainError->IsOK() )
+      mainError = SMESH_ComputeError::New( COMPERR_EXCEPTION, errText, this );
+  }
+  std::lock_guard< std::mutex > lock( _computeMutex );
+  if ( _isAsyncCanceled )
+    _computeState = COMPUTE_CANCELED;
+  else
+    _computeState = ok ? COMPUTE_DONE : COMPUTE_FAILED;
+  _computeEnd.notify_all();
 }
 
 //================================================================================
@@ -3015,17 +5270,13 @@ void GHS3DPlugin_GHS3D::SetEventListener(SMESH_subMesh* subMesh)
 
 double GHS3DPlugin_GHS3D::GetProgress() const
 {
-  if ( _isLibUsed )
-  {
-    // this->_progress is advanced by MG_Tetra_API according to messages from MG library
-    // but sharply. Advance it a bit to get smoother advancement.
-    GHS3DPlugin_GHS3D* me = const_cast<GHS3DPlugin_GHS3D*>( this );
-    if ( _progress < 0.1 ) // the first message is at 10%
-      me->_progress = GetProgressByTic();
-    else if ( _progress < 0.98 )
-      me->_progress += _progressAdvance;
-    return _progress;
-  }
-
-  return -1;
+  // this->_progress is advanced by MG_Tetra_API according to messages from MG library
+  // or to the log printed by the executable, but sharply. Advance it a bit to get
+  // smoother advancement.
+  GHS3DPlugin_GHS3D* me = const_cast<GHS3DPlugin_GHS3D*>( this );
+  if ( _progress < 0.1 ) // the first message is at 10%
+    me->_progress = GetProgressByTic();
+  else if ( _progress < 0.98 )
+    me->_progress += _progressAdvance;
+  return _progress;
 }
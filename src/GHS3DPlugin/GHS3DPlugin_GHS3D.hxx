@@ -31,7 +31,11 @@
 #include <SMESH_Gen_i.hxx>
 #include <SMESH_ProxyMesh.hxx>
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #ifndef GMFVERSION
@@ -77,6 +81,22 @@ public:
 
   virtual double GetProgress() const;
 
+  /*!
+   * \brief Stage of a computation started by StartCompute()
+   */
+  enum TComputeState { COMPUTE_NOT_STARTED,
+                       COMPUTE_PREPARING,      // other algorithms are running
+                       COMPUTE_WRITING_INPUT,  // MG-Tetra input is being prepared
+                       COMPUTE_MESHING,        // MG-Tetra is running
+                       COMPUTE_READING_OUTPUT, // MG-Tetra result is being imported
+                       COMPUTE_DONE,
+                       COMPUTE_FAILED,
+                       COMPUTE_CANCELED };
+
+  bool          StartCompute( SMESH_Mesh& theMesh );
+  TComputeState GetComputeState() const { return _computeState; }
+  bool          WaitCompute( double theTimeout ); // theTimeout < 0 means no timeout
+  void          CancelAsyncCompute();
 
   static const char* Name() { return "MG-Tetra"; }
 
@@ -94,14 +114,34 @@ private:
 
   TopoDS_Shape entryToShape(std::string entry);
 
+  bool isComputing() const;
+  void setComputeState( TComputeState state );
+  void computeAsync();
+  void joinComputeThread();
+
+  // concurrent meshing of solids
+  struct TSolidRuns;
+  struct TSolidRun;
+  bool canComputeSolidsConcurrently( SMESH_Mesh& theMesh, const TopoDS_Shape& theShape ) const;
+  bool computeSolidsConcurrently( SMESH_Mesh& theMesh, const TopoDS_Shape& theShape );
+  void computeSolids( TSolidRuns* theRuns );
+  bool computeSolid( TSolidRuns& theRuns, TSolidRun& theRun );
+
   int                 _iShape;
   int                 _nbShape;
   bool                _keepFiles;
   bool                _removeLogOnSuccess;
   bool                _logInStandardOutput;
 
-  bool                _isLibUsed;
   double              _progressAdvance;
+
+  // asynchronous computation
+  SMESH_Mesh*                  _asyncMesh;
+  std::thread                  _computeThread;
+  std::atomic< TComputeState > _computeState;
+  std::atomic< bool >          _isAsyncCanceled;
+  std::mutex                   _computeMutex;
+  std::condition_variable      _computeEnd;
 };
 
 /*!
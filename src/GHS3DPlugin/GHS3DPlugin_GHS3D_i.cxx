@@ -28,11 +28,13 @@
 #include "GHS3DPlugin_GHS3D.hxx"
 #include "GHS3DPlugin_Optimizer.hxx"
 
+#include <SMESHDS_Mesh.hxx>
 #include <SMESH_Gen.hxx>
 #include <SMESH_Gen_i.hxx>
 #include <SMESH_Mesh_i.hxx>
 #include <SMESH_PythonDump.hxx>
 
+#include <Utils_CorbaException.hxx>
 #include <utilities.h>
 #include <cstring>
 
@@ -112,6 +114,116 @@ SMESH::SMESH_Mesh_ptr GHS3DPlugin_GHS3D_i::importGMFMesh(const char* theGMFFileN
   return theMesh;
 }
 
+//=============================================================================
+/*!
+ *  GHS3DPlugin_GHS3D_i::StartCompute
+ *
+ *  Start computing a mesh in a separate thread
+ */
+//=============================================================================
+
+CORBA::Boolean GHS3DPlugin_GHS3D_i::StartCompute( SMESH::SMESH_Mesh_ptr theMesh )
+{
+  SMESH_Mesh_i* meshServant = SMESH::DownCast< SMESH_Mesh_i* >( theMesh );
+  if ( !meshServant )
+    THROW_SALOME_CORBA_EXCEPTION( "Invalid mesh", SALOME::BAD_PARAM );
+
+  // as SMESH_Gen_i::Compute() does
+  meshServant->Load();
+  meshServant->CheckGeomModif();
+  if ( !GetImpl()->StartCompute( meshServant->GetImpl() ))
+    return false;
+
+  myComputedMesh = SMESH::SMESH_Mesh::_duplicate( theMesh );
+
+  SMESH::TPythonDump() << _this() << ".StartCompute( " << theMesh << " )";
+  return true;
+}
+
+//=============================================================================
+/*!
+ *  GHS3DPlugin_GHS3D_i::GetComputeState
+ *
+ *  Return stage of a computation started by StartCompute()
+ */
+//=============================================================================
+
+GHS3DPlugin::ComputeState GHS3DPlugin_GHS3D_i::GetComputeState()
+{
+  return GHS3DPlugin::ComputeState( GetImpl()->GetComputeState() );
+}
+
+//=============================================================================
+/*!
+ *  GHS3DPlugin_GHS3D_i::GetComputeProgress
+ *
+ *  Return progress of MG-Tetra run [0.,1.]
+ */
+//=============================================================================
+
+CORBA::Double GHS3DPlugin_GHS3D_i::GetComputeProgress()
+{
+  switch ( GetImpl()->GetComputeState() )
+  {
+  case ::GHS3DPlugin_GHS3D::COMPUTE_NOT_STARTED:
+  case ::GHS3DPlugin_GHS3D::COMPUTE_PREPARING:
+  case ::GHS3DPlugin_GHS3D::COMPUTE_WRITING_INPUT: return 0.;
+  case ::GHS3DPlugin_GHS3D::COMPUTE_MESHING:
+  case ::GHS3DPlugin_GHS3D::COMPUTE_READING_OUTPUT: return GetImpl()->GetProgress();
+  default:;
+  }
+  return 1.;
+}
+
+//=============================================================================
+/*!
+ *  GHS3DPlugin_GHS3D_i::WaitCompute
+ *
+ *  Wait for the end of a computation started by StartCompute()
+ */
+//=============================================================================
+
+CORBA::Boolean GHS3DPlugin_GHS3D_i::WaitCompute( CORBA::Double theTimeout )
+{
+  if ( !GetImpl()->WaitCompute( theTimeout ))
+    return false;
+
+  if ( !CORBA::is_nil( myComputedMesh ))
+  {
+    // publish groups created by the computation and update the study
+    // as SMESH_Gen_i::Compute() does
+    if ( SMESH_Mesh_i* meshServant = SMESH::DownCast< SMESH_Mesh_i* >( myComputedMesh ))
+    {
+      meshServant->CreateGroupServants();
+      meshServant->GetImpl().GetMeshDS()->Modified();
+    }
+    SMESH_Gen_i* smeshGen = SMESH_Gen_i::GetSMESHGen();
+    smeshGen->UpdateIcons( myComputedMesh );
+    if ( GetImpl()->GetComputeState() == ::GHS3DPlugin_GHS3D::COMPUTE_DONE )
+      smeshGen->HighLightInvalid( myComputedMesh, /*isInvalid=*/false );
+    SALOMEDS::Study_var study = smeshGen->getStudyServant();
+    if ( !study->_is_nil() )
+      study->Modified();
+    myComputedMesh = SMESH::SMESH_Mesh::_nil();
+
+    SMESH::TPythonDump() << _this() << ".WaitCompute( -1 )";
+  }
+  return true;
+}
+
+//=============================================================================
+/*!
+ *  GHS3DPlugin_GHS3D_i::CancelCompute
+ *
+ *  Cancel a computation started by StartCompute()
+ */
+//=============================================================================
+
+void GHS3DPlugin_GHS3D_i::CancelCompute()
+{
+  GetImpl()->CancelAsyncCompute();
+}
+
 //=============================================================================
 /*!
  *  GHS3DPlugin_Optimizer_i::GHS3DPlugin_Optimizer_i
@@ -50,6 +50,17 @@ public:
   ::GHS3DPlugin_GHS3D* GetImpl();
 
   virtual SMESH::SMESH_Mesh_ptr importGMFMesh(const char* theGMFFileName);
+
+  // Asynchronous computation
+  virtual CORBA::Boolean             StartCompute( SMESH::SMESH_Mesh_ptr theMesh );
+  virtual GHS3DPlugin::ComputeState  GetComputeState();
+  virtual CORBA::Double              GetComputeProgress();
+  virtual CORBA::Boolean             WaitCompute( CORBA::Double theTimeout );
+  virtual void                       CancelCompute();
+
+private:
+
+  SMESH::SMESH_Mesh_var myComputedMesh;
 };
 
 // ======================================================
@@ -75,6 +75,10 @@ GHS3DPlugin_Hypothesis::GHS3DPlugin_Hypothesis(int hypId, SMESH_Gen * gen)
     myUseNumOfThreads(DefaultUseNumOfThreads()),
     myPthreadModeMG(DefaultMyPthreadMode()),
     myPthreadModeMGHPC(DefaultMyPthreadModeHPC()),
+    myUseBinaryFiles(DefaultUseBinaryFiles()),
+    myToSortInputNodes(DefaultToSortInputNodes()),
+    myToRenumberResult(DefaultToRenumberResult()),
+    myToMeshSolidsConcurrently(DefaultToMeshSolidsConcurrently()),
     myMinSize(0),
     myMinSizeDefault(0),
     myMaxSize(0),
@@ -670,6 +674,117 @@ bool GHS3DPlugin_Hypothesis::GetRemoveLogOnSuccess() const
   return myRemoveLogOnSuccess;
 }
 
+//=======================================================================
+//function : SetUseBinaryFiles
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis::SetUseBinaryFiles(bool toUseBinary)
+{
+  if ( myUseBinaryFiles != toUseBinary ) {
+    myUseBinaryFiles = toUseBinary;
+    NotifySubMeshesHypothesisModification();
+  }
+}
+
+//=======================================================================
+//function : GetUseBinaryFiles
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetUseBinaryFiles() const
+{
+  return myUseBinaryFiles;
+}
+
+//=======================================================================
+//function : SetToSortInputNodes
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis::SetToSortInputNodes(bool toSort)
+{
+  if ( myToSortInputNodes != toSort ) {
+    myToSortInputNodes = toSort;
+    NotifySubMeshesHypothesisModification();
+  }
+}
+
+//=======================================================================
+//function : GetToSortInputNodes
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToSortInputNodes() const
+{
+  return myToSortInputNodes;
+}
+
+//=======================================================================
+//function : GetToSortInputNodes
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToSortInputNodes(const GHS3DPlugin_Hypothesis* hyp)
+{
+  return hyp ? hyp->GetToSortInputNodes() : DefaultToSortInputNodes();
+}
+
+//=======================================================================
+//function : SetToRenumberResult
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis::SetToRenumberResult(bool toRenumber)
+{
+  if ( myToRenumberResult != toRenumber ) {
+    myToRenumberResult = toRenumber;
+    NotifySubMeshesHypothesisModification();
+  }
+}
+
+//=======================================================================
+//function : GetToRenumberResult
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToRenumberResult() const
+{
+  return myToRenumberResult;
+}
+
+//=======================================================================
+//function : GetToRenumberResult
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToRenumberResult(const GHS3DPlugin_Hypothesis* hyp)
+{
+  return hyp ? hyp->GetToRenumberResult() : DefaultToRenumberResult();
+}
+
+//=======================================================================
+//function : SetToMeshSolidsConcurrently
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis::SetToMeshSolidsConcurrently(bool toMeshConcurrently)
+{
+  if ( myToMeshSolidsConcurrently != toMeshConcurrently ) {
+    myToMeshSolidsConcurrently = toMeshConcurrently;
+    NotifySubMeshesHypothesisModification();
+  }
+}
+
+//=======================================================================
+//function : GetToMeshSolidsConcurrently
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToMeshSolidsConcurrently() const
+{
+  return myToMeshSolidsConcurrently;
+}
+
+//=======================================================================
+//function : GetToMeshSolidsConcurrently
+//=======================================================================
+
+bool GHS3DPlugin_Hypothesis::GetToMeshSolidsConcurrently(const GHS3DPlugin_Hypothesis* hyp)
+{
+  return hyp ? hyp->GetToMeshSolidsConcurrently() : DefaultToMeshSolidsConcurrently();
+}
+
 //=======================================================================
 //function : SetEnforcedVertex
 //=======================================================================
@@ -1359,6 +1474,11 @@ std::ostream & GHS3DPlugin_Hypothesis::SaveTo(std::ostream & save)
   save << " " << myPthreadModeMG;
   save << " " << myPthreadModeMGHPC;
 
+  save << " " << myUseBinaryFiles;
+  save << " " << myToSortInputNodes;
+  save << " " << myToRenumberResult;
+  save << " " << myToMeshSolidsConcurrently;
+
   return save;
 }
 
@@ -1745,6 +1865,30 @@ std::istream & GHS3DPlugin_Hypothesis::LoadFrom(std::istream & load)
   else
     load.clear(ios::badbit | load.rdstate());
 
+  isOK = static_cast<bool>(load >> i);
+  if (isOK)
+    myUseBinaryFiles = (bool) i;
+  else
+    load.clear(ios::badbit | load.rdstate());
+
+  isOK = static_cast<bool>(load >> i);
+  if (isOK)
+    myToSortInputNodes = (bool) i;
+  else
+    load.clear(ios::badbit | load.rdstate());
+
+  isOK = static_cast<bool>(load >> i);
+  if (isOK)
+    myToRenumberResult = (bool) i;
+  else
+    load.clear(ios::badbit | load.rdstate());
+
+  isOK = static_cast<bool>(load >> i);
+  if (isOK)
+    myToMeshSolidsConcurrently = (bool) i;
+  else
+    load.clear(ios::badbit | load.rdstate());
+
   return load;
 }
 
@@ -1979,6 +2123,47 @@ std::string GHS3DPlugin_Hypothesis::GetFileName(const GHS3DPlugin_Hypothesis* hy
   return aGenericName.ToCString();
 }
 
+//================================================================================
+/*!
+ * \brief Return true if binary GMF files are to be used.
+ *        MG_TETRA_USE_BINARY_FILES environment variable overrides the hypothesis
+ */
+//================================================================================
+
+bool GHS3DPlugin_Hypothesis::UseBinaryFiles(const GHS3DPlugin_Hypothesis* hyp)
+{
+  if ( const char* envValue = getenv("MG_TETRA_USE_BINARY_FILES"))
+  {
+    bool isOk;
+    bool toUse = ToBool( envValue, &isOk );
+    if ( isOk )
+      return toUse;
+  }
+  return hyp ? hyp->GetUseBinaryFiles() : DefaultUseBinaryFiles();
+}
+
+//================================================================================
+/*!
+ * \brief Return extension of GMF mesh files
+ */
+//================================================================================
+
+std::string GHS3DPlugin_Hypothesis::MeshFileExtension(const GHS3DPlugin_Hypothesis* hyp)
+{
+  return UseBinaryFiles( hyp ) ? ".meshb" : ".mesh";
+}
+
+//================================================================================
+/*!
+ * \brief Return extension of GMF solution files
+ */
+//================================================================================
+
+std::string GHS3DPlugin_Hypothesis::SolFileExtension(const GHS3DPlugin_Hypothesis* hyp)
+{
+  return UseBinaryFiles( hyp ) ? ".solb" : ".sol";
+}
+
 //================================================================================
 /*!
  * \brief Return a unique file name when running MGTetra HPC
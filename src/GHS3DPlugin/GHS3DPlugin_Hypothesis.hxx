@@ -257,6 +257,26 @@ public:
   */
   void SetRemoveLogOnSuccess(bool removeLogOnSuccess);
   bool GetRemoveLogOnSuccess() const;
+  /*!
+   * To exchange binary .meshb/.solb files with MG-Tetra executable
+   */
+  void SetUseBinaryFiles(bool toUseBinary);
+  bool GetUseBinaryFiles() const;
+  /*!
+   * To pass surface nodes to MG-Tetra sorted along a Hilbert curve
+   */
+  void SetToSortInputNodes(bool toSort);
+  bool GetToSortInputNodes() const;
+  /*!
+   * To create nodes and volumes generated by MG-Tetra in a cache-friendly order
+   */
+  void SetToRenumberResult(bool toRenumber);
+  bool GetToRenumberResult() const;
+  /*!
+   * To mesh solids of a multi-solid shape by concurrent MG-Tetra runs
+   */
+  void SetToMeshSolidsConcurrently(bool toMeshConcurrently);
+  bool GetToMeshSolidsConcurrently() const;
     
 
   typedef std::map< std::string, std::string > TOptionValues;
@@ -294,6 +314,25 @@ public:
    * \brief Return a unique file name
    */
   static std::string GetFileName(const GHS3DPlugin_Hypothesis* hyp);
+  /*!
+   * \brief Return true if binary GMF files are to be used, which can be
+   *        forced by MG_TETRA_USE_BINARY_FILES environment variable
+   */
+  static bool UseBinaryFiles(const GHS3DPlugin_Hypothesis* hyp);
+  /*!
+   * \brief Return extension of GMF mesh and solution files
+   */
+  static std::string MeshFileExtension(const GHS3DPlugin_Hypothesis* hyp);
+  static std::string SolFileExtension (const GHS3DPlugin_Hypothesis* hyp);
+  /*!
+   * \brief Return true if surface nodes are to be sorted along a Hilbert curve
+   */
+  static bool GetToSortInputNodes(const GHS3DPlugin_Hypothesis* hyp);
+  /*!
+   * \brief Return true if the generated mesh is to be created in a cache-friendly order
+   */
+  static bool GetToRenumberResult(const GHS3DPlugin_Hypothesis* hyp);
+  static bool GetToMeshSolidsConcurrently(const GHS3DPlugin_Hypothesis* hyp);
   /*!
    * \brief Return a unique file name for MGTetraHPC will have a GHS3D prefix
    */
@@ -366,6 +405,10 @@ public:
   static bool   DefaultToRemoveCentralPoint();
   static bool   DefaultStandardOutputLog();
   static bool   DefaultRemoveLogOnSuccess();
+  static bool   DefaultUseBinaryFiles() { return false; }
+  static bool   DefaultToSortInputNodes() { return false; }
+  static bool   DefaultToRenumberResult() { return false; }
+  static bool   DefaultToMeshSolidsConcurrently() { return false; }
   static inline double DefaultGradation() { return 1.05; }
   static bool   DefaultUseVolumeProximity() { return false; }
   static int    DefaultNbVolumeProximityLayers() { return 2; }
@@ -422,6 +465,10 @@ protected:
   bool        myUseNumOfThreads;
   short       myPthreadModeMG;
   short       myPthreadModeMGHPC;
+  bool        myUseBinaryFiles;
+  bool        myToSortInputNodes;
+  bool        myToRenumberResult;
+  bool        myToMeshSolidsConcurrently;
   double      myMinSize, myMinSizeDefault;
   double      myMaxSize, myMaxSizeDefault;
   //std::string myTextOption;
@@ -906,6 +906,90 @@ CORBA::Boolean GHS3DPlugin_Hypothesis_i::GetRemoveLogOnSuccess()
   return this->GetImpl()->GetRemoveLogOnSuccess();
 }
 
+//=======================================================================
+//function : SetUseBinaryFiles
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis_i::SetUseBinaryFiles(CORBA::Boolean toUseBinary)
+{
+  ASSERT(myBaseImpl);
+  this->GetImpl()->SetUseBinaryFiles(toUseBinary);
+  SMESH::TPythonDump() << _this() << ".SetUseBinaryFiles( " << toUseBinary << " )";
+}
+
+//=======================================================================
+//function : GetUseBinaryFiles
+//=======================================================================
+
+CORBA::Boolean GHS3DPlugin_Hypothesis_i::GetUseBinaryFiles()
+{
+  ASSERT(myBaseImpl);
+  return this->GetImpl()->GetUseBinaryFiles();
+}
+
+//=======================================================================
+//function : SetToSortInputNodes
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis_i::SetToSortInputNodes(CORBA::Boolean toSort)
+{
+  ASSERT(myBaseImpl);
+  this->GetImpl()->SetToSortInputNodes(toSort);
+  SMESH::TPythonDump() << _this() << ".SetToSortInputNodes( " << toSort << " )";
+}
+
+//=======================================================================
+//function : GetToSortInputNodes
+//=======================================================================
+
+CORBA::Boolean GHS3DPlugin_Hypothesis_i::GetToSortInputNodes()
+{
+  ASSERT(myBaseImpl);
+  return this->GetImpl()->GetToSortInputNodes();
+}
+
+//=======================================================================
+//function : SetToRenumberResult
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis_i::SetToRenumberResult(CORBA::Boolean toRenumber)
+{
+  ASSERT(myBaseImpl);
+  this->GetImpl()->SetToRenumberResult(toRenumber);
+  SMESH::TPythonDump() << _this() << ".SetToRenumberResult( " << toRenumber << " )";
+}
+
+//=======================================================================
+//function : GetToRenumberResult
+//=======================================================================
+
+CORBA::Boolean GHS3DPlugin_Hypothesis_i::GetToRenumberResult()
+{
+  ASSERT(myBaseImpl);
+  return this->GetImpl()->GetToRenumberResult();
+}
+
+//=======================================================================
+//function : SetToMeshSolidsConcurrently
+//=======================================================================
+
+void GHS3DPlugin_Hypothesis_i::SetToMeshSolidsConcurrently(CORBA::Boolean toMeshConcurrently)
+{
+  ASSERT(myBaseImpl);
+  this->GetImpl()->SetToMeshSolidsConcurrently(toMeshConcurrently);
+  SMESH::TPythonDump() << _this() << ".SetToMeshSolidsConcurrently( " << toMeshConcurrently << " )";
+}
+
+//=======================================================================
+//function : GetToMeshSolidsConcurrently
+//=======================================================================
+
+CORBA::Boolean GHS3DPlugin_Hypothesis_i::GetToMeshSolidsConcurrently()
+{
+  ASSERT(myBaseImpl);
+  return this->GetImpl()->GetToMeshSolidsConcurrently();
+}
+
 //=======================================================================
 //function : SetEnforcedVertex
 //=======================================================================
@@ -201,6 +201,26 @@ class GHS3DPLUGIN_EXPORT GHS3DPlugin_Hypothesis_i:
   */
   void SetRemoveLogOnSuccess(CORBA::Boolean removeLogOnSuccess);
   CORBA::Boolean GetRemoveLogOnSuccess();
+  /*!
+   * To exchange binary .meshb/.solb files with MG-Tetra executable
+   */
+  void SetUseBinaryFiles(CORBA::Boolean toUseBinary);
+  CORBA::Boolean GetUseBinaryFiles();
+  /*!
+   * To pass surface nodes to MG-Tetra sorted along a Hilbert curve
+   */
+  void SetToSortInputNodes(CORBA::Boolean toSort);
+  CORBA::Boolean GetToSortInputNodes();
+  /*!
+   * To create nodes and volumes generated by MG-Tetra in a cache-friendly order
+   */
+  void SetToRenumberResult(CORBA::Boolean toRenumber);
+  CORBA::Boolean GetToRenumberResult();
+  /*!
+   * To mesh solids of a multi-solid shape by concurrent MG-Tetra runs
+   */
+  void SetToMeshSolidsConcurrently(CORBA::Boolean toMeshConcurrently);
+  CORBA::Boolean GetToMeshSolidsConcurrently();
   /*!
    * To set an enforced vertex
    */
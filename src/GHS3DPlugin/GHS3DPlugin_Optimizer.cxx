@@ -30,9 +30,12 @@
 #include <SMESH_File.hxx>
 #include <SMESH_Mesh.hxx>
 #include <SMESH_MesherHelper.hxx>
+#include <SMESH_Utils.hxx>
 
 #include <TopoDS_Shape.hxx>
 
+#include <algorithm>
+
 //================================================================================
 /*!
  * \brief Constructor
@@ -153,61 +156,81 @@ namespace
                      const std::string&  theMeshFileName,
                      const std::string&  theSolFileName )
   {
-    const int tag = 0;
+    SMESHDS_Mesh* meshDS = theHelper->GetMeshDS();
 
-    int mfile = theMGInput->GmfOpenMesh( theMeshFileName.c_str(), GmfWrite, GMFVERSION,GMFDIMENSION );
-    int sfile = theMGInput->GmfOpenMesh( theSolFileName.c_str(), GmfWrite, GMFVERSION,GMFDIMENSION );
+    // file sizes: 3 coordinates and a reference per vertex, nodes and a reference
+    // per element, a size per vertex
+    const SMDS_MeshInfo& meshInfo = meshDS->GetMeshInfo();
+    const double nbMeshBytes = ( ( 3 * 8 + 4 ) * double( meshInfo.NbNodes() ) +
+                                 4 * 4 * double( meshInfo.NbTriangles() ) +
+                                 5 * 4 * double( meshInfo.NbTetras() ));
+    const double nbSolBytes  = 8 * double( meshInfo.NbNodes() );
+
+    int mfile = theMGInput->GmfOpenMesh( theMeshFileName.c_str(), GmfWrite,
+                                         MG_Tetra_API::GmfVersion( GMFVERSION, theMeshFileName.c_str(),
+                                                                   nbMeshBytes ), GMFDIMENSION );
+    int sfile = theMGInput->GmfOpenMesh( theSolFileName.c_str(), GmfWrite,
+                                         MG_Tetra_API::GmfVersion( GMFVERSION, theSolFileName.c_str(),
+                                                                   nbSolBytes ), GMFDIMENSION );
     if ( !mfile || !sfile )
       return false;
 
     // write all nodes and volume size at them
 
-    SMESHDS_Mesh* meshDS = theHelper->GetMeshDS();
     if ( meshDS->NbNodes() != meshDS->MaxNodeID() )
       meshDS->CompactMesh();
 
-    theMGInput->GmfSetKwd( mfile, GmfVertices, (int) meshDS->NbNodes() );
+    const int nbNodes = (int) meshDS->NbNodes();
+    theMGInput->GmfSetKwd( mfile, GmfVertices, nbNodes );
     int TypTab[] = { GmfSca };
-    theMGInput->GmfSetKwd( sfile, GmfSolAtVertices, (int) meshDS->NbNodes(), 1, TypTab);
+    theMGInput->GmfSetKwd( sfile, GmfSolAtVertices, nbNodes, 1, TypTab);
 
+    std::vector< const SMDS_MeshNode* > nodes;
+    std::vector< double > sizes;
+    nodes.reserve( nbNodes );
+    sizes.reserve( nbNodes );
     SMDS_NodeIteratorPtr nodeIt = theHelper->GetMeshDS()->nodesIterator();
     while ( nodeIt->more() )
     {
       const SMDS_MeshNode* node = nodeIt->next();
-      theMGInput->GmfSetLin( mfile, GmfVertices, node->X(), node->Y(), node->Z(), tag );
-
-      double size = getSizeAtNode( node );
-      theMGInput->GmfSetLin( sfile, GmfSolAtVertices, &size );
+      nodes.push_back( node );
+      sizes.push_back( getSizeAtNode( node ));
     }
+    theMGInput->GmfSetBlock( mfile, GmfVertices, std::move( nodes )); // MG-Tetra keeps nodes
+    theMGInput->GmfSetBlock( sfile, GmfSolAtVertices, &sizes[0], nbNodes );
+    SMESHUtils::FreeVector( sizes );
 
     // write all triangles
 
-    theMGInput->GmfSetKwd( mfile, GmfTriangles, (int) meshDS->GetMeshInfo().NbTriangles() );
+    const int nbTria = (int) meshDS->GetMeshInfo().NbTriangles();
+    theMGInput->GmfSetKwd( mfile, GmfTriangles, nbTria );
+    std::vector< int > elemNodes;
+    elemNodes.reserve( 3 * nbTria );
     SMDS_ElemIteratorPtr triaIt = meshDS->elementGeomIterator( SMDSGeom_TRIANGLE );
     while ( triaIt->more() )
     {
       const SMDS_MeshElement* tria = triaIt->next();
-      theMGInput->GmfSetLin( mfile, GmfTriangles,
-                             static_cast<int>(tria->GetNode(0)->GetID()),
-                             static_cast<int>(tria->GetNode(1)->GetID()),
-                             static_cast<int>(tria->GetNode(2)->GetID()),
-                             tag );
+      elemNodes.push_back( static_cast<int>(tria->GetNode(0)->GetID()) );
+      elemNodes.push_back( static_cast<int>(tria->GetNode(1)->GetID()) );
+      elemNodes.push_back( static_cast<int>(tria->GetNode(2)->GetID()) );
     }
+    theMGInput->GmfSetBlock( mfile, GmfTriangles, std::move( elemNodes ), 3 );
 
     // write all tetra
 
-    theMGInput->GmfSetKwd( mfile, GmfTetrahedra, (int) meshDS->GetMeshInfo().NbTetras() );
+    const int nbTet = (int) meshDS->GetMeshInfo().NbTetras();
+    theMGInput->GmfSetKwd( mfile, GmfTetrahedra, nbTet );
+    elemNodes.reserve( 4 * nbTet ); // elemNodes is emptied by GmfSetBlock()
     SMDS_ElemIteratorPtr tetIt = meshDS->elementGeomIterator( SMDSGeom_TETRA );
     while ( tetIt->more() )
     {
       const SMDS_MeshElement* tet = tetIt->next();
-      theMGInput->GmfSetLin( mfile, GmfTetrahedra,
-                             static_cast<int>(tet->GetNode(0)->GetID()),
-                             static_cast<int>(tet->GetNode(2)->GetID()),
-                             static_cast<int>(tet->GetNode(1)->GetID()),
-                             static_cast<int>(tet->GetNode(3)->GetID()),
-                             tag );
+      elemNodes.push_back( static_cast<int>(tet->GetNode(0)->GetID()) );
+      elemNodes.push_back( static_cast<int>(tet->GetNode(2)->GetID()) );
+      elemNodes.push_back( static_cast<int>(tet->GetNode(1)->GetID()) );
+      elemNodes.push_back( static_cast<int>(tet->GetNode(3)->GetID()) );
     }
+    theMGInput->GmfSetBlock( mfile, GmfTetrahedra, std::move( elemNodes ), 4 );
 
     theMGInput->GmfCloseMesh( mfile );
     theMGInput->GmfCloseMesh( sfile );
@@ -225,7 +248,7 @@ namespace
                     SMESH_MesherHelper* theHelper,
                     const std::string&  theMeshFileName )
   {
-    int ver, dim, tag;
+    int ver, dim;
     int inFile = theMGOutput->GmfOpenMesh( theMeshFileName.c_str(), GmfRead, &ver, &dim);
     if ( !inFile )
       return false;
@@ -241,9 +264,30 @@ namespace
     std::cout << "Optimization output: "
               << nbNodes << " nodes, \t" << nbTet << " tetra" << std::endl;
 
-    double x,y,z;
-    int i1, i2, i3, i4;
-    theMGOutput->GmfGotoKwd( inFile, GmfVertices );
+    // read all nodes and tetra
+
+    std::vector< double > xyz( 3 * size_t( nbNodes ));
+    std::vector< int >    tetNodes( 4 * size_t( nbTet ));
+    bool isRead = true;
+    if ( nbNodes > 0 )
+    {
+      theMGOutput->GmfGotoKwd( inFile, GmfVertices );
+      isRead = theMGOutput->GmfGetBlock( inFile, GmfVertices, &xyz[0], nbNodes );
+    }
+    if ( nbTet > 0 && isRead )
+    {
+      theMGOutput->GmfGotoKwd( inFile, GmfTetrahedra );
+      isRead = theMGOutput->GmfGetBlock( inFile, GmfTetrahedra, &tetNodes[0], /*domains=*/0, 4, nbTet );
+    }
+    theMGOutput->GmfCloseMesh( inFile );
+
+    for ( size_t i = 0; i < tetNodes.size() && isRead; ++i )
+      isRead = ( 0 < tetNodes[ i ] && tetNodes[ i ] <= nbNodes );
+    if ( !isRead )
+      return false;
+
+    const double* coo = xyz.data();
+    const int*      n = tetNodes.data();
 
     if ( nbNodes == nbNodesOld && nbTet == nbTetOld )
     {
@@ -252,36 +296,33 @@ namespace
       while ( nodeIt->more() )
       {
         const SMDS_MeshNode* node = nodeIt->next();
-        theMGOutput->GmfGetLin( inFile, GmfVertices, &x, &y, &z, &tag );
-        meshDS->MoveNode( node, x,y,z );
+        meshDS->MoveNode( node, coo[0], coo[1], coo[2] );
+        coo += 3;
       }
 
       // update tetra
       const SMDS_MeshNode* nodes[ 4 ];
-      theMGOutput->GmfGotoKwd( inFile, GmfTetrahedra );
       SMDS_ElemIteratorPtr tetIt = meshDS->elementGeomIterator( SMDSGeom_TETRA );
-      for ( int i = 0; i < nbTet; ++i )
+      for ( int i = 0; i < nbTet; ++i, n += 4 )
       {
         const SMDS_MeshElement* tet = tetIt->next();
-        theMGOutput->GmfGetLin( inFile, GmfTetrahedra, &i1, &i2, &i3, &i4, &tag);
-        nodes[ 0 ] = meshDS->FindNode( i1 );
-        nodes[ 1 ] = meshDS->FindNode( i3 );
-        nodes[ 2 ] = meshDS->FindNode( i2 );
-        nodes[ 3 ] = meshDS->FindNode( i4 );
+        nodes[ 0 ] = meshDS->FindNode( n[0] );
+        nodes[ 1 ] = meshDS->FindNode( n[2] );
+        nodes[ 2 ] = meshDS->FindNode( n[1] );
+        nodes[ 3 ] = meshDS->FindNode( n[3] );
         meshDS->ChangeElementNodes( tet, &nodes[0], 4 );
       }
     }
     else if ( nbNodes >= nbNodesOld ) // tetra added/removed
     {
       // move or add nodes
-      for ( int iN = 1; iN <= nbNodes; ++iN )
+      for ( int iN = 1; iN <= nbNodes; ++iN, coo += 3 )
       {
-        theMGOutput->GmfGetLin( inFile, GmfVertices, &x, &y, &z, &tag );
         const SMDS_MeshNode* node = meshDS->FindNode( iN );
         if ( !node )
-          node = meshDS->AddNode( x,y,z );
+          node = meshDS->AddNode( coo[0], coo[1], coo[2] );
         else
-          meshDS->MoveNode( node, x,y,z );
+          meshDS->MoveNode( node, coo[0], coo[1], coo[2] );
       }
 
       // remove tetrahedra
@@ -290,14 +331,12 @@ namespace
         meshDS->RemoveFreeElement( tetIt->next(), /*sm=*/0 );
 
       // add tetrahedra
-      theMGOutput->GmfGotoKwd( inFile, GmfTetrahedra );
-      for ( int i = 0; i < nbTet; ++i )
+      for ( int i = 0; i < nbTet; ++i, n += 4 )
       {
-        theMGOutput->GmfGetLin( inFile, GmfTetrahedra, &i1, &i2, &i3, &i4, &tag);
-        meshDS->AddVolume( meshDS->FindNode( i1 ),
-                           meshDS->FindNode( i3 ),
-                           meshDS->FindNode( i2 ),
-                           meshDS->FindNode( i4 ));
+        meshDS->AddVolume( meshDS->FindNode( n[0] ),
+                           meshDS->FindNode( n[2] ),
+                           meshDS->FindNode( n[1] ),
+                           meshDS->FindNode( n[3] ));
       }
     }
     else if ( nbNodes < nbNodesOld ) // nodes and tetra removed
@@ -320,25 +359,22 @@ namespace
       }
 
       // move or add nodes
-      for ( int iN = 1; iN <= nbNodes; ++iN )
+      for ( int iN = 1; iN <= nbNodes; ++iN, coo += 3 )
       {
-        theMGOutput->GmfGetLin( inFile, GmfVertices, &x, &y, &z, &tag );
         const SMDS_MeshNode* node = meshDS->FindNode( iN );
         if ( !node )
-          node = meshDS->AddNode( x,y,z );
+          node = meshDS->AddNode( coo[0], coo[1], coo[2] );
         else
-          meshDS->MoveNode( node, x,y,z );
+          meshDS->MoveNode( node, coo[0], coo[1], coo[2] );
       }
 
       // add tetrahedra
-      theMGOutput->GmfGotoKwd( inFile, GmfTetrahedra );
-      for ( int i = 0; i < nbTet; ++i )
+      for ( int i = 0; i < nbTet; ++i, n += 4 )
       {
-        theMGOutput->GmfGetLin( inFile, GmfTetrahedra, &i1, &i2, &i3, &i4, &tag);
-        meshDS->AddVolume( meshDS->FindNode( i1 ),
-                           meshDS->FindNode( i3 ),
-                           meshDS->FindNode( i2 ),
-                           meshDS->FindNode( i4 ));
+        meshDS->AddVolume( meshDS->FindNode( n[0] ),
+                           meshDS->FindNode( n[2] ),
+                           meshDS->FindNode( n[1] ),
+                           meshDS->FindNode( n[3] ));
       }
 
       // remove free marked nodes
@@ -395,13 +431,18 @@ bool GHS3DPlugin_Optimizer::Compute(SMESH_Mesh&         theMesh,
     return error( COMPERR_BAD_INPUT_MESH, "Quadratic mesh can't be optimized" );
   if ( theMesh.NbTriangles() == 0 )
     return error( COMPERR_BAD_INPUT_MESH, "2D mesh must exist around tetrahedra" );
+  if ( !MG_Tetra_API::CanExchange( theMesh.NbNodes() ) ||
+       !MG_Tetra_API::CanExchange( theMesh.NbTetras() ))
+    return error( COMPERR_BAD_INPUT_MESH, "Too many nodes or tetrahedra to be passed to MG-Tetra" );
 
   std::string aGenericName    = GHS3DPlugin_Hypothesis::GetFileName(_hyp);
+  std::string meshExt         = GHS3DPlugin_Hypothesis::MeshFileExtension(_hyp); // ASCII or binary
+  std::string solExt          = GHS3DPlugin_Hypothesis::SolFileExtension(_hyp);
   std::string aLogFileName    = aGenericName + ".log";  // log
-  std::string aGMFFileName    = aGenericName + ".mesh"; // input GMF mesh file
-  std::string aSolFileName    = aGenericName + ".sol";  // input size map file
-  std::string aResultFileName = aGenericName + "_Opt.mesh";  // out GMF mesh file
-  std::string aResSolFileName = aGenericName + "_Opt.sol";   // out size map file
+  std::string aGMFFileName    = aGenericName + meshExt; // input GMF mesh file
+  std::string aSolFileName    = aGenericName + solExt;  // input size map file
+  std::string aResultFileName = aGenericName + "_Opt" + meshExt;  // out GMF mesh file
+  std::string aResSolFileName = aGenericName + "_Opt" + solExt;   // out size map file
 
   MG_Tetra_API mgTetra( _computeCanceled, _progress );
 
@@ -452,6 +493,7 @@ bool GHS3DPlugin_Optimizer::Compute(SMESH_Mesh&         theMesh,
   // --------------
   // read a result
   // --------------
+  const bool isComputed = Ok;
   Ok = Ok && readGMFFile( &mgTetra, theHelper, aResultFileName );
 
   // ---------------------
@@ -477,6 +519,8 @@ bool GHS3DPlugin_Optimizer::Compute(SMESH_Mesh&         theMesh,
     INFOS( "MG-Tetra Error, " << errStr);
     error(COMPERR_ALGO_FAILED, errStr);
   }
+  if ( isComputed && !Ok && !_computeCanceled )
+    error( COMPERR_ALGO_FAILED, "Can't read the MG-Tetra result file " + aResultFileName );
 
   if ( Ok && removeLogOnSuccess )
   {
@@ -495,6 +539,14 @@ bool GHS3DPlugin_Optimizer::Compute(SMESH_Mesh&         theMesh,
 }
 
 
-// double GHS3DPlugin_Optimizer::GetProgress() const
-// {
-// }
+//================================================================================
+/*!
+ * \brief Return progress of computation [0.,1.]
+ */
+//================================================================================
+
+double GHS3DPlugin_Optimizer::GetProgress() const
+{
+  // this->_progress is advanced by MG_Tetra_API according to messages from MG-Tetra
+  return std::max( _progress, GetProgressByTic() );
+}
@@ -49,7 +49,7 @@ public:
 
   static const char* Name() { return "MG-Tetra Optimization"; }
 
-  //virtual double GetProgress() const;
+  virtual double GetProgress() const;
 
 private:
 
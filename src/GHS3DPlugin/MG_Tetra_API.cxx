@@ -18,21 +18,79 @@
 //
 
 #include "MG_Tetra_API.hxx"
+#include "MG_Tetra_Budget.hxx"
+#include "MG_Tetra_GmfReader.hxx"
+#include "MG_Tetra_Process.hxx"
 
 #ifdef WIN32
 #define NOMINMAX
 #endif
 
+#include <SMDS_MeshNode.hxx>
 #include <SMESH_Comment.hxx>
 #include <SMESH_File.hxx>
 #include <SMESH_MGLicenseKeyGen.hxx>
 #include <Utils_SALOME_Exception.hxx>
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <iostream>
 #include <iterator>
 #include <vector>
 
+namespace
+{
+  //================================================================================
+  /*!
+   * \brief Advance progress according to a message of MG-Tetra
+   *  \param [in] msg - a message of the library or a line of the executable output
+   *  \param [in,out] progress - progress to update
+   *  \param [in,out] progressInMessages - true if MG-Tetra reports progress explicitly
+   */
+  //================================================================================
+
+  void updateProgress( const char* msg, double& progress, bool& progressInMessages )
+  {
+    if ( strncmp( "MGMESSAGE  1009001 ", msg, 19 ) == 0 )
+    {
+      // progress message (10%): "MGMESSAGE  1009001  0 1 1.000000e+01"
+      progress = atof( msg + 24 );
+
+      progressInMessages = true;
+    }
+
+    if ( progressInMessages )
+      return;
+
+    // Compute progress
+    // corresponding messages are:
+    // "  -- PHASE 1 COMPLETED"               => 10 %
+    // "  -- PHASE 2 COMPLETED"               => 25 %
+    // "     ** ITERATION   1"                => 25.* %
+    // "     ** ITERATION   2"                => 25.* %
+    // "  -- PHASE 3 COMPLETED"               => 70 %
+    // "  -- PHASE 4 COMPLETED"               => 98 %
+
+    while ( isspace( *msg )) // indentation differs in the executable output
+      ++msg;
+
+    if ( strncmp( "-- PHASE ", msg, 9 ) == 0 && strstr( msg + 9, "COMPLETED" ))
+    {
+      const double percent[] = { 10., 25., 70., 98., 100., 100., 100. };
+      int phase = atoi( msg + 9 );
+      if ( phase >= 1 && phase <= 7 )
+        progress = std::max( progress, percent[ phase - 1 ] / 100. );
+    }
+    else if ( strncmp( "** ITERATION ", msg, 13 ) == 0 )
+    {
+      int         iter = atoi( msg + 13 );
+      double   percent = 25. + iter * ( 70 - 25 ) / 20.;
+      progress = std::max( progress, std::min( percent, 70. ) / 100. );
+    }
+  }
+}
+
 #ifdef USE_MG_LIBS
 
 extern "C"{
@@ -50,7 +108,9 @@ struct MG_Tetra_API::LibData
   mesh_t *          _tetra_mesh;
 
   // data to pass to MG
+  std::vector<const SMDS_MeshNode*> _nodes; // nodes preceding ones of _xyz
   std::vector<double> _xyz;
+  int                 _nbVerticesToAdd;
   std::vector<double> _nodeSize; // required nodes
   std::vector<int>    _edgeNodes;
   int                 _nbRequiredEdges;
@@ -66,7 +126,7 @@ struct MG_Tetra_API::LibData
 
   LibData( volatile bool & cancelled_flag, double& progress )
     : _context(0), _session(0), _tria_mesh(0), _sizemap(0), _tetra_mesh(0),
-      _nbRequiredEdges(0), _nbRequiredTria(0),
+      _nbVerticesToAdd(0), _nbRequiredEdges(0), _nbRequiredTria(0),
       _cancelled_flag( cancelled_flag ), _progress( progress ), _progressInCallBack( false )
   {
   }
@@ -75,6 +135,16 @@ struct MG_Tetra_API::LibData
   bool Compute();
 
   ~LibData()
+  {
+    Release();
+    if ( _context )
+      context_delete( _context );
+    _context = 0;
+  }
+
+  // Free the resulting mesh, the session and the input data as soon as
+  // the result is read, not to keep both MeshGems and SMESH meshes in memory
+  void Release()
   {
     if ( _tetra_mesh )
       tetra_regain_mesh( _session, _tetra_mesh );
@@ -84,14 +154,18 @@ struct MG_Tetra_API::LibData
       mesh_delete( _tria_mesh );
     if ( _sizemap )
       sizemap_delete( _sizemap );
-    if ( _context )
-      context_delete( _context );
 
     _tetra_mesh = 0;
     _session = 0;
     _tria_mesh = 0;
     _sizemap = 0;
-    _context = 0;
+
+    std::vector<const SMDS_MeshNode*>().swap( _nodes );
+    std::vector<double>().swap( _xyz );
+    std::vector<double>().swap( _nodeSize );
+    std::vector<int>().swap( _edgeNodes );
+    std::vector<int>().swap( _triaNodes );
+    std::vector<int>().swap( _tetraNodes );
   }
 
   void AddError( const char *txt )
@@ -319,9 +393,73 @@ struct MG_Tetra_API::LibData
     ++_count;
   }
 
+  void ReadNodesXYZ( double* xyz, int nb )
+  {
+    real coo[3];
+    status_t ret = STATUS_OK;
+    for ( int i = 0; i < nb && ret == STATUS_OK; ++i, ++_count, xyz += 3 )
+    {
+      ret = mesh_get_vertex_coordinates( _tetra_mesh, _count, coo );
+      xyz[0] = coo[0];
+      xyz[1] = coo[1];
+      xyz[2] = coo[2];
+    }
+    if ( ret != STATUS_OK ) MG_Error( "unable to get resulting vertices" );
+  }
+
+  void ReadElemNodes( GmfKwdCod what, int* nodes, int* domains, int nbNodesPerElem, int nb )
+  {
+    // choose accessors once for the whole block
+    typedef status_t (*TGetFun)( mesh_t*, integer, integer* );
+    TGetFun getVertices = 0, getTag = 0;
+    switch ( what ) {
+    case GmfEdges:
+      getVertices = mesh_get_edge_vertices;        getTag = mesh_get_edge_tag;        break;
+    case GmfTriangles:
+      getVertices = mesh_get_triangle_vertices;    getTag = mesh_get_triangle_tag;    break;
+    case GmfQuadrilaterals:
+      getVertices = mesh_get_quadrangle_vertices;  getTag = mesh_get_quadrangle_tag;  break;
+    case GmfTetrahedra:
+      getVertices = mesh_get_tetrahedron_vertices; getTag = mesh_get_tetrahedron_tag; break;
+    case GmfHexahedra:
+      getVertices = mesh_get_hexahedron_vertices;  getTag = mesh_get_hexahedron_tag;  break;
+    default: // corners, ridges
+      std::fill( nodes, nodes + size_t( nb ) * nbNodesPerElem, 0 );
+      if ( domains )
+        std::fill( domains, domains + nb, 0 );
+      _count += nb;
+      return;
+    }
+    if ( !domains )
+      getTag = 0;
+
+    integer vtx[8], tag = 0;
+    status_t ret = STATUS_OK;
+    for ( int i = 0; i < nb; ++i, ++_count, nodes += nbNodesPerElem )
+    {
+      ret = getVertices( _tetra_mesh, _count, vtx );
+      if ( getTag && ret == STATUS_OK )
+        ret = getTag( _tetra_mesh, _count, &tag );
+      if ( ret != STATUS_OK )
+        break;
+      for ( int iN = 0; iN < nbNodesPerElem; ++iN )
+        nodes[ iN ] = vtx[ iN ];
+      if ( domains )
+        domains[ i ] = tag;
+    }
+    if ( ret != STATUS_OK ) MG_Error( "unable to get resulting elements" );
+  }
+
   void SetNbVertices( int nb )
   {
-    _xyz.reserve( _xyz.capacity() + nb );
+    _nbVerticesToAdd = nb; // _xyz is reserved if coordinates come
+  }
+
+  void reserveVertices()
+  {
+    if ( _nbVerticesToAdd > 0 )
+      _xyz.reserve( _xyz.size() + 3 * _nbVerticesToAdd );
+    _nbVerticesToAdd = 0;
   }
 
   void SetNbEdges( int nb )
@@ -356,6 +494,7 @@ struct MG_Tetra_API::LibData
 
   void AddNode( double x, double y, double z, int /*domain*/ )
   {
+    reserveVertices();
     _xyz.push_back( x );
     _xyz.push_back( y );
     _xyz.push_back( z );
@@ -387,14 +526,88 @@ struct MG_Tetra_API::LibData
     _tetraNodes.push_back( node4 );
   }
 
+  void AddNodes( const double* xyz, int nb )
+  {
+    reserveVertices();
+    _xyz.insert( _xyz.end(), xyz, xyz + 3 * nb );
+  }
+
+  void AddNodes( std::vector<const SMDS_MeshNode*>&& nodes )
+  {
+    if ( _xyz.empty() )
+    {
+      _nbVerticesToAdd = 0;
+      if ( _nodes.empty() )
+        _nodes = std::move( nodes );
+      else
+        _nodes.insert( _nodes.end(), nodes.begin(), nodes.end() );
+    }
+    else // keep order of nodes
+    {
+      reserveVertices();
+      for ( size_t i = 0; i < nodes.size(); ++i )
+      {
+        _xyz.push_back( nodes[i]->X() );
+        _xyz.push_back( nodes[i]->Y() );
+        _xyz.push_back( nodes[i]->Z() );
+      }
+    }
+    std::vector<const SMDS_MeshNode*>().swap( nodes );
+  }
+
+  void AddSizesAtNodes( const double* sizes, int nb )
+  {
+    _nodeSize.insert( _nodeSize.end(), sizes, sizes + nb );
+  }
+
+  void AddElemNodes( GmfKwdCod what, const int* nodes, int nbNodesPerElem, int nb )
+  {
+    const int* end = nodes + nbNodesPerElem * nb;
+    switch ( what ) {
+    case GmfEdges:      _edgeNodes.insert ( _edgeNodes.end(),  nodes, end ); break;
+    case GmfTriangles:  _triaNodes.insert ( _triaNodes.end(),  nodes, end ); break;
+    case GmfTetrahedra: _tetraNodes.insert( _tetraNodes.end(), nodes, end ); break;
+    default:; // required entities are defined by counts
+    }
+  }
+
+  void AddElemNodes( GmfKwdCod what, std::vector<int>&& nodes )
+  {
+    std::vector<int>* elemNodes = 0;
+    switch ( what ) {
+    case GmfEdges:      elemNodes = & _edgeNodes;  break;
+    case GmfTriangles:  elemNodes = & _triaNodes;  break;
+    case GmfTetrahedra: elemNodes = & _tetraNodes; break;
+    default: return;
+    }
+    if ( elemNodes->empty() )
+      *elemNodes = std::move( nodes );
+    else
+      elemNodes->insert( elemNodes->end(), nodes.begin(), nodes.end() );
+    std::vector<int>().swap( nodes );
+  }
+
   int NbNodes()
   {
-    return _xyz.size() / 3;
+    return int( _nodes.size() + _xyz.size() / 3 );
   }
 
-  double* NodeCoord( int iNode )
+  void GetNodeCoord( int iNode, real* xyz )
   {
-    return & _xyz[ iNode * 3 ];
+    if ( iNode < (int) _nodes.size() )
+    {
+      const SMDS_MeshNode* node = _nodes[ iNode ];
+      xyz[0] = node->X();
+      xyz[1] = node->Y();
+      xyz[2] = node->Z();
+    }
+    else
+    {
+      const double* coord = & _xyz[ ( iNode - _nodes.size() ) * 3 ];
+      xyz[0] = coord[0];
+      xyz[1] = coord[1];
+      xyz[2] = coord[2];
+    }
   }
 
   int NbEdges()
@@ -451,9 +664,7 @@ namespace // functions called by MG library to exchange with the application
   status_t get_vertex_coordinates(integer ivtx, real * xyz, void *user_data)
   {
     MG_Tetra_API::LibData* data = (MG_Tetra_API::LibData *) user_data;
-    double* coord = data->NodeCoord( ivtx-1 );
-    for (int j = 0; j < 3; j++)
-      xyz[j] = coord[j];
+    data->GetNodeCoord( ivtx-1, xyz );
 
     return STATUS_OK;
   }
@@ -561,38 +772,7 @@ namespace // functions called by MG library to exchange with the application
     //std::cout << desc << std::endl;
 #endif
 
-    if ( strncmp( "MGMESSAGE  1009001 ", desc, 19 ) == 0 )
-    {
-      // progress message (10%): "MGMESSAGE  1009001  0 1 1.000000e+01"
-      data->_progress = atof( desc + 24 );
-
-      data->_progressInCallBack = true;
-    }
-
-    if ( !data->_progressInCallBack )
-    {
-      // Compute progress
-      // corresponding messages are:
-      // "  -- PHASE 1 COMPLETED"               => 10 %
-      // "  -- PHASE 2 COMPLETED"               => 25 %
-      // "     ** ITERATION   1"                => 25.* %
-      // "     ** ITERATION   2"                => 25.* %
-      // "  -- PHASE 3 COMPLETED"               => 70 %
-      // "  -- PHASE 4 COMPLETED"               => 98 %
-
-      if ( strncmp( "-- PHASE ", desc + 2, 9 ) == 0 && desc[ 13 ] == 'C' )
-      {
-        const double progress[] = { 10., 25., 70., 98., 100., 100., 100. };
-        int       phase = atoi( desc + 11 );
-        data->_progress = std::max( data->_progress, progress[ phase - 1 ] / 100. );
-      }
-      else if ( strncmp( "** ITERATION ", desc + 5, 13 ) == 0 )
-      {
-        int         iter = atoi( desc + 20 );
-        double   percent = 25. + iter * ( 70 - 25 ) / 20.;
-        data->_progress = std::max( data->_progress, ( percent / 100. ));
-      }
-    }
+    updateProgress( desc, data->_progress, data->_progressInCallBack );
 
     return STATUS_OK;
   }
@@ -720,6 +900,135 @@ struct MG_Tetra_API::LibData // to avoid compiler warnings
 
 #endif // ifdef USE_MG_LIBS
 
+namespace
+{
+  //================================================================================
+  /*!
+   * \brief Return a reader of a file mapped into memory
+   */
+  //================================================================================
+
+  MG_Tetra_GmfReader* findReader( std::map<int,MG_Tetra_GmfReader*>& readers, int iMesh )
+  {
+    if ( iMesh >= 0 )
+      return 0;
+    std::map<int,MG_Tetra_GmfReader*>::iterator id2r = readers.find( iMesh );
+    return id2r == readers.end() ? 0 : id2r->second;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Advances progress while mg-tetra.exe prints its log
+   */
+  //================================================================================
+
+  struct TProgressListener : public MG_Tetra_Process::LineListener
+  {
+    double& _progress;
+    bool    _progressInMessages;
+
+    TProgressListener( double& progress ): _progress( progress ), _progressInMessages( false ) {}
+
+    virtual void OnLine( const std::string& line )
+    {
+      updateProgress( line.c_str(), _progress, _progressInMessages );
+    }
+  };
+
+  //================================================================================
+  /*!
+   * \brief Run mg-tetra.exe in a supervised child process.
+   *
+   * Address space of the process is limited to MG_TETRA_MEMORY_LIMIT
+   * environment variable value (MB), if any.
+   */
+  //================================================================================
+
+  bool runExecutable( const std::string& cmdLine,
+                      volatile bool&     isCancelled,
+                      double&            progress,
+                      std::string&       errStr )
+  {
+    TProgressListener progressListener( progress );
+
+    MG_Tetra_Process process;
+    process.SetCancelFlag( &isCancelled );
+    process.SetLineListener( &progressListener );
+    if ( const char* limit = getenv("MG_TETRA_MEMORY_LIMIT"))
+      process.SetMemoryLimit( (size_t) std::max( 0L, atol( limit )));
+
+    return process.Run( cmdLine, errStr );
+  }
+
+  //================================================================================
+  /*!
+   * \brief Find a value of a command line option
+   *  \param [in] cmdLine - the command line
+   *  \param [in] option - the option, e.g. "--max_memory"
+   *  \param [out] pos - position of the value in cmdLine
+   *  \param [out] len - length of the value
+   *  \return bool - true if the option is found
+   */
+  //================================================================================
+
+  bool findOptionValue( const std::string& cmdLine, const std::string& option,
+                        size_t& pos, size_t& len )
+  {
+    const std::string word = " " + option + " ";
+    size_t optPos = cmdLine.rfind( word ); // the last value is used by MG-Tetra
+    if ( optPos == std::string::npos )
+      return false;
+
+    pos = cmdLine.find_first_not_of( ' ', optPos + word.size() );
+    if ( pos == std::string::npos )
+      return false;
+    len = cmdLine.find( ' ', pos );
+    len = ( len == std::string::npos ? cmdLine.size() : len ) - pos;
+    return true;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Take threads and memory for a run from the budget shared by concurrent
+   *        runs and set them to --max_number_of_threads and --max_memory options
+   *  \return bool - false if cancelled while waiting for free resources
+   */
+  //================================================================================
+
+  bool acquireBudget( std::string&            cmdLine,
+                      volatile bool&          isCancelled,
+                      MG_Tetra_Budget::Grant& grant )
+  {
+    size_t threadsPos = 0, threadsLen = 0, memoryPos = 0, memoryLen = 0;
+    const bool hasThreads = findOptionValue( cmdLine, "--max_number_of_threads", threadsPos, threadsLen );
+    const bool hasMemory  = findOptionValue( cmdLine, "--max_memory", memoryPos, memoryLen );
+
+    // if the number of threads is not given, the run is accounted as one thread
+    int    nbThreads = hasThreads ? atoi( cmdLine.c_str() + threadsPos ) : 1;
+    double memoryMB  = hasMemory  ? atof( cmdLine.c_str() + memoryPos  ) : 0.;
+
+    if ( !MG_Tetra_Budget::Acquire( nbThreads, size_t( std::max( 0., memoryMB )), &isCancelled, grant ))
+      return false;
+
+    // replace the rightmost value first not to move the other one
+    std::string threadsValue = SMESH_Comment( grant.NbThreads() );
+    std::string memoryValue  = SMESH_Comment( grant.MemoryMB() );
+    if ( hasThreads && hasMemory && threadsPos < memoryPos )
+    {
+      cmdLine.replace( memoryPos, memoryLen, memoryValue );
+      cmdLine.replace( threadsPos, threadsLen, threadsValue );
+    }
+    else
+    {
+      if ( hasThreads ) cmdLine.replace( threadsPos, threadsLen, threadsValue );
+      if ( hasMemory )  cmdLine.replace( memoryPos,  memoryLen,  memoryValue );
+    }
+    if ( grant.NbThreads() != nbThreads || ( hasMemory && grant.MemoryMB() < size_t( memoryMB )))
+      std::cout << "MG-Tetra is given " << grant.NbThreads() << " threads and "
+                << grant.MemoryMB() << " MB" << std::endl;
+    return true;
+  }
+}
 
 //================================================================================
 /*!
@@ -756,6 +1065,11 @@ MG_Tetra_API::~MG_Tetra_API()
   for ( ; id != _openFiles.end(); ++id )
     ::GmfCloseMesh( *id );
   _openFiles.clear();
+
+  std::map<int,MG_Tetra_GmfReader*>::iterator id2r = _readers.begin();
+  for ( ; id2r != _readers.end(); ++id2r )
+    delete id2r->second;
+  _readers.clear();
 }
 
 //================================================================================
@@ -783,13 +1097,23 @@ void MG_Tetra_API::SetUseExecutable()
 //================================================================================
 /*!
  * \brief Compute the tetra mesh
- *  \param [in] cmdLine - a command to run mg_tetra.exe
+ *  \param [in] theCmdLine - a command to run mg_tetra.exe
  *  \return bool - Ok or not
+ *
+ * Number of threads and memory of the run are limited by MG_Tetra_Budget.
  */
 //================================================================================
 
-bool MG_Tetra_API::Compute( const std::string& cmdLine, std::string& errStr )
+bool MG_Tetra_API::Compute( const std::string& theCmdLine, std::string& errStr )
 {
+  std::string cmdLine = theCmdLine;
+  MG_Tetra_Budget::Grant grant;
+  if ( !acquireBudget( cmdLine, _libData->_cancelled_flag, grant ))
+  {
+    errStr = "interruption initiated by user";
+    return false;
+  }
+
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
 
@@ -844,17 +1168,10 @@ bool MG_Tetra_API::Compute( const std::string& cmdLine, std::string& errStr )
     }
 
     if ( key != "0")
-      const_cast< std::string& >( cmdLine ) += " --key " + key;
+      cmdLine += " --key " + key;
   }
 
-  int err = system( cmdLine.c_str() ); // run
-
-  if ( err )
-    errStr = SMESH_Comment("system(mg-tetra.exe ...) command failed with error: ")
-      << strerror( errno );
-
-  return !err;
-
+  return runExecutable( cmdLine, _libData->_cancelled_flag, _libData->_progress, errStr );
 }
 
 //================================================================================
@@ -870,8 +1187,23 @@ int  MG_Tetra_API::GmfOpenMesh(const char* theFile, int rdOrWr, int * ver, int *
     return 1;
 #endif
   }
+  if ( rdOrWr == GmfRead )
+  {
+    // map the file into memory; libmesh5 is used if the file is not supported
+    MG_Tetra_GmfReader* reader = new MG_Tetra_GmfReader;
+    if ( reader->Open( theFile ))
+    {
+      int id = _readers.empty() ? -1 : _readers.begin()->first - 1;
+      _readers[ id ] = reader;
+      *ver = reader->Version();
+      *dim = reader->Dimension();
+      return id;
+    }
+    delete reader;
+  }
   int id = ::GmfOpenMesh(theFile, rdOrWr, ver, dim );
   _openFiles.insert( id );
+  _fileVersion[ id ] = *ver;
   return id;
 }
 
@@ -899,6 +1231,8 @@ int MG_Tetra_API::GmfStatKwd( int iMesh, GmfKwdCod what )
     return 0;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+    return reader->NbLines( what );
   return ::GmfStatKwd( iMesh, what );
 }
 
@@ -916,6 +1250,11 @@ void MG_Tetra_API::GmfGotoKwd( int iMesh, GmfKwdCod what )
     return;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    reader->GotoKwd( what );
+    return;
+  }
   ::GmfGotoKwd( iMesh, what );
 }
 
@@ -933,15 +1272,27 @@ void MG_Tetra_API::GmfGotoKwd( int iMesh, GmfKwdCod what )
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin( int iMesh, GmfKwdCod what, int* nbNodes, int* faceInd, int* ori, int* domain, int /*dummy*/ )
+bool MG_Tetra_API::GmfGetLin( int iMesh, GmfKwdCod what, int* nbNodes, int* faceInd, int* ori, int* domain, int /*dummy*/ )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
     _libData->ReadSubDomain( nbNodes, faceInd, ori, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    int values[4] = { 0, 0, 0, 0 };
+    if ( !reader->GetIntegers( values, 4, 1 ))
+      return false;
+    *nbNodes = values[0];
+    *faceInd = values[1];
+    *ori     = values[2];
+    *domain  = values[3];
+    return true;
+  }
   ::GmfGetLin( iMesh, what, nbNodes, faceInd, ori, domain );
+  return true;
 }
 
 //================================================================================
@@ -950,16 +1301,27 @@ void MG_Tetra_API::GmfGetLin( int iMesh, GmfKwdCod what, int* nbNodes, int* face
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
                              double* x, double* y, double *z, int* domain )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
     _libData->ReadNodeXYZ( x, y, z, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    double xyz[3];
+    if ( !reader->GetVertices( xyz, domain, 1 ))
+      return false;
+    *x = xyz[0];
+    *y = xyz[1];
+    *z = xyz[2];
+    return true;
+  }
   ::GmfGetLin(iMesh, what, x, y, z, domain );
+  return true;
 }
 
 //================================================================================
@@ -968,7 +1330,7 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
                              float* x, float* y, float *z, int* domain )
 {
   if ( _useLib ) {
@@ -978,10 +1340,21 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
     *x = X;
     *y = Y;
     *z = Z;
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    double xyz[3];
+    if ( !reader->GetVertices( xyz, domain, 1 ))
+      return false;
+    *x = xyz[0];
+    *y = xyz[1];
+    *z = xyz[2];
+    return true;
+  }
   ::GmfGetLin(iMesh, what, x, y, z, domain );
+  return true;
 }
 
 //================================================================================
@@ -990,15 +1363,18 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node )
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
     node = 0;
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+    return reader->GetIntegers( node, 1, 1 );
   ::GmfGetLin(iMesh, what, node );
+  return true;
 }
 
 //================================================================================
@@ -1007,15 +1383,24 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node )
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* domain )
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* domain )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
     _libData->ReadEdgeNodes( node1, node2, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    int n[2];
+    if ( !reader->GetElements( n, domain, 2, 1 ))
+      return false;
+    *node1 = n[0]; *node2 = n[1];
+    return true;
+  }
   ::GmfGetLin( iMesh, what, node1, node2, domain );
+  return true;
 }
 
 //================================================================================
@@ -1024,16 +1409,25 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2,
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
                              int* node1, int* node2, int* node3, int* domain )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
     _libData->ReadTriaNodes( node1, node2, node3, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    int n[3];
+    if ( !reader->GetElements( n, domain, 3, 1 ))
+      return false;
+    *node1 = n[0]; *node2 = n[1]; *node3 = n[2];
+    return true;
+  }
   ::GmfGetLin(iMesh, what, node1, node2, node3, domain );
+  return true;
 }
 
 //================================================================================
@@ -1042,7 +1436,7 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
                              int* node1, int* node2, int* node3, int* node4, int* domain )
 {
   if ( _useLib ) {
@@ -1051,10 +1445,19 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
       _libData->ReadQuadNodes( node1, node2, node3, node4, domain );
     else
       _libData->ReadTetraNodes( node1, node2, node3, node4, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    int n[4];
+    if ( !reader->GetElements( n, domain, 4, 1 ))
+      return false;
+    *node1 = n[0]; *node2 = n[1]; *node3 = n[2]; *node4 = n[3];
+    return true;
+  }
   ::GmfGetLin(iMesh, what, node1, node2, node3, node4, domain );
+  return true;
 }
 
 //================================================================================
@@ -1063,7 +1466,7 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
  */
 //================================================================================
 
-void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
+bool MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
                              int* node1, int* node2, int* node3, int* node4,
                              int* node5, int* node6, int* node7, int* node8,
                              int* domain )
@@ -1072,10 +1475,114 @@ void MG_Tetra_API::GmfGetLin(int iMesh, GmfKwdCod what,
 #ifdef USE_MG_LIBS
     _libData->ReadHexaNodes( node1, node2, node3, node4,
                              node5, node6, node7, node8, domain );
-    return;
+    return true;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    int n[8];
+    if ( !reader->GetElements( n, domain, 8, 1 ))
+      return false;
+    *node1 = n[0]; *node2 = n[1]; *node3 = n[2]; *node4 = n[3];
+    *node5 = n[4]; *node6 = n[5]; *node7 = n[6]; *node8 = n[7];
+    return true;
+  }
   ::GmfGetLin(iMesh, what, node1, node2, node3, node4, node5, node6, node7, node8, domain );
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Return coordinates of next nodes
+ *  \param [in] iMesh - mesh file index
+ *  \param [in] what - must be GmfVertices
+ *  \param [out] xyz - array of 3 * nb coordinates to fill in
+ *  \param [in] nb - nb of nodes to read
+ */
+//================================================================================
+
+bool MG_Tetra_API::GmfGetBlock(int iMesh, GmfKwdCod what, double* xyz, int nb )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    _libData->ReadNodesXYZ( xyz, nb );
+    return true;
+#endif
+  }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+    return reader->GetVertices( xyz, /*domains=*/0, nb );
+  int domain;
+  if ( _fileVersion[ iMesh ] == GmfFloat )
+  {
+    float x, y, z;
+    for ( int i = 0; i < nb; ++i, xyz += 3 )
+    {
+      ::GmfGetLin( iMesh, what, &x, &y, &z, &domain );
+      xyz[0] = x;
+      xyz[1] = y;
+      xyz[2] = z;
+    }
+  }
+  else
+  {
+    for ( int i = 0; i < nb; ++i, xyz += 3 )
+      ::GmfGetLin( iMesh, what, &xyz[0], &xyz[1], &xyz[2], &domain );
+  }
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Return node indices and domains of next elements
+ *  \param [in] iMesh - mesh file index
+ *  \param [in] what - element type
+ *  \param [out] nodes - array of nbNodesPerElem * nb node indices to fill in
+ *  \param [out] domains - array of nb domains to fill in; can be NULL
+ *  \param [in] nbNodesPerElem - nb of nodes of an element of type \a what
+ *  \param [in] nb - nb of elements to read
+ */
+//================================================================================
+
+bool MG_Tetra_API::GmfGetBlock(int iMesh, GmfKwdCod what,
+                               int* nodes, int* domains, int nbNodesPerElem, int nb )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    _libData->ReadElemNodes( what, nodes, domains, nbNodesPerElem, nb );
+    return true;
+#endif
+  }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+    return reader->GetElements( nodes, domains, nbNodesPerElem, nb );
+  int  dummy;
+  int* d = domains ? domains : &dummy;
+  const int dInc = domains ? 1 : 0;
+  int* n = nodes;
+  switch ( nbNodesPerElem ) {
+  case 1: // corners, ridges
+    for ( int i = 0; i < nb; ++i, n += 1 )
+      ::GmfGetLin( iMesh, what, &n[0] );
+    break;
+  case 2:
+    for ( int i = 0; i < nb; ++i, n += 2, d += dInc )
+      ::GmfGetLin( iMesh, what, &n[0], &n[1], d );
+    break;
+  case 3:
+    for ( int i = 0; i < nb; ++i, n += 3, d += dInc )
+      ::GmfGetLin( iMesh, what, &n[0], &n[1], &n[2], d );
+    break;
+  case 4:
+    for ( int i = 0; i < nb; ++i, n += 4, d += dInc )
+      ::GmfGetLin( iMesh, what, &n[0], &n[1], &n[2], &n[3], d );
+    break;
+  case 8:
+    for ( int i = 0; i < nb; ++i, n += 8, d += dInc )
+      ::GmfGetLin( iMesh, what, &n[0], &n[1], &n[2], &n[3], &n[4], &n[5], &n[6], &n[7], d );
+    break;
+  default:
+    return false;
+  }
+  return true;
 }
 
 //================================================================================
@@ -1257,6 +1764,154 @@ void MG_Tetra_API::GmfSetLin(int iMesh, GmfKwdCod what,
   ::GmfSetLin(iMesh, what, node1, node2, node3, node4, domain );
 }
 
+//================================================================================
+/*!
+ * \brief Add coordinates of nodes or solution data
+ *  \param [in] iMesh - mesh or solution file index
+ *  \param [in] what - GmfVertices or GmfSolAtVertices
+ *  \param [in] values - 3 * nb coordinates of nodes or nb scalar values at nodes
+ *  \param [in] nb - nb of entities
+ *
+ * Can be called several times after GmfSetKwd()
+ */
+//================================================================================
+
+void MG_Tetra_API::GmfSetBlock(int iMesh, GmfKwdCod what, const double* values, int nb )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    if ( what == GmfSolAtVertices )
+      _libData->AddSizesAtNodes( values, nb );
+    else
+      _libData->AddNodes( values, nb );
+    return;
+#endif
+  }
+  if ( what == GmfSolAtVertices )
+  {
+    for ( int i = 0; i < nb; ++i )
+      ::GmfSetLin( iMesh, what, const_cast< double* >( values + i ));
+  }
+  else
+  {
+    const int domain = 0;
+    for ( int i = 0; i < nb; ++i, values += 3 )
+      ::GmfSetLin( iMesh, what, values[0], values[1], values[2], domain );
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Add nodes of elements or indices of required entities
+ *  \param [in] iMesh - mesh file index
+ *  \param [in] what - element type or a 'required' keyword
+ *  \param [in] nodes - nbNodesPerElem * nb node indices (or nb indices of required entities)
+ *  \param [in] nbNodesPerElem - nb of nodes of an element (1 for required entities)
+ *  \param [in] nb - nb of entities
+ *
+ * Can be called several times after GmfSetKwd()
+ */
+//================================================================================
+
+void MG_Tetra_API::GmfSetBlock(int iMesh, GmfKwdCod what,
+                               const int* nodes, int nbNodesPerElem, int nb )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    _libData->AddElemNodes( what, nodes, nbNodesPerElem, nb );
+    return;
+#endif
+  }
+  const int domain = 0;
+  const int* n = nodes;
+  switch ( nbNodesPerElem ) {
+  case 1: // required
+    for ( int i = 0; i < nb; ++i, n += 1 )
+      ::GmfSetLin( iMesh, what, n[0] );
+    break;
+  case 2:
+    for ( int i = 0; i < nb; ++i, n += 2 )
+      ::GmfSetLin( iMesh, what, n[0], n[1], domain );
+    break;
+  case 3:
+    for ( int i = 0; i < nb; ++i, n += 3 )
+      ::GmfSetLin( iMesh, what, n[0], n[1], n[2], domain );
+    break;
+  case 4:
+    for ( int i = 0; i < nb; ++i, n += 4 )
+      ::GmfSetLin( iMesh, what, n[0], n[1], n[2], n[3], domain );
+    break;
+  default:;
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Add coordinates of nodes
+ *  \param [in] iMesh - mesh file index
+ *  \param [in] what - GmfVertices
+ *  \param [in] nodes - nodes to pass; in library mode the vector is moved to MG-Tetra
+ *         input data and the nodes must exist until end of Compute()
+ *
+ * Can be called several times after GmfSetKwd()
+ */
+//================================================================================
+
+void MG_Tetra_API::GmfSetBlock(int iMesh, GmfKwdCod what,
+                               std::vector<const SMDS_MeshNode*>&& nodes )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    _libData->AddNodes( std::move( nodes ));
+    return;
+#endif
+  }
+  // write by blocks not to copy all coordinates at once
+  const size_t blockSize = 65536;
+  std::vector< double > xyz;
+  xyz.reserve( 3 * std::min( blockSize, nodes.size() ));
+  for ( size_t iBlock = 0; iBlock < nodes.size(); iBlock += blockSize )
+  {
+    const size_t iEnd = std::min( iBlock + blockSize, nodes.size() );
+    xyz.clear();
+    for ( size_t i = iBlock; i < iEnd; ++i )
+    {
+      xyz.push_back( nodes[i]->X() );
+      xyz.push_back( nodes[i]->Y() );
+      xyz.push_back( nodes[i]->Z() );
+    }
+    GmfSetBlock( iMesh, what, &xyz[0], int( iEnd - iBlock ));
+  }
+  std::vector<const SMDS_MeshNode*>().swap( nodes );
+}
+
+//================================================================================
+/*!
+ * \brief Add nodes of elements
+ *  \param [in] iMesh - mesh file index
+ *  \param [in] what - element type
+ *  \param [in] nodes - node indices of elements; in library mode the vector is moved
+ *         to MG-Tetra input data
+ *  \param [in] nbNodesPerElem - nb of nodes of an element
+ *
+ * Can be called several times after GmfSetKwd()
+ */
+//================================================================================
+
+void MG_Tetra_API::GmfSetBlock(int iMesh, GmfKwdCod what,
+                               std::vector<int>&& nodes, int nbNodesPerElem )
+{
+  if ( _useLib ) {
+#ifdef USE_MG_LIBS
+    _libData->AddElemNodes( what, std::move( nodes ));
+    return;
+#endif
+  }
+  if ( !nodes.empty() )
+    GmfSetBlock( iMesh, what, &nodes[0], nbNodesPerElem, int( nodes.size() / nbNodesPerElem ));
+  std::vector<int>().swap( nodes );
+}
+
 //================================================================================
 /*!
  * \brief Close a file
@@ -1267,11 +1922,20 @@ void MG_Tetra_API::GmfCloseMesh( int iMesh )
 {
   if ( _useLib ) {
 #ifdef USE_MG_LIBS
+    if ( _libData->_tetra_mesh ) // the result is read
+      _libData->Release();
     return;
 #endif
   }
+  if ( MG_Tetra_GmfReader* reader = findReader( _readers, iMesh ))
+  {
+    delete reader;
+    _readers.erase( iMesh );
+    return;
+  }
   ::GmfCloseMesh( iMesh );
   _openFiles.erase( iMesh );
+  _fileVersion.erase( iMesh );
 }
 
 //================================================================================
@@ -24,8 +24,16 @@ extern "C"
 {
 #include "libmesh5.h"
 }
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <map>
 #include <string>
 #include <set>
+#include <vector>
+
+class MG_Tetra_GmfReader;
+class SMDS_MeshNode;
 
 /*!
  * \brief Class providing a transparent switch between MG_Tetra usage as
@@ -42,6 +50,20 @@ public:
   bool IsExecutable() { return !IsLibrary(); }
   void SetUseExecutable();
 
+  // Check if a number of entities of one kind can be exchanged with MG-Tetra:
+  // both libmesh5 and MeshGems library count and refer to entities by 32-bit integers
+  static bool CanExchange( size_t nbEntities )
+  { return nbEntities <= size_t( std::numeric_limits<int>::max() ); }
+
+  // Return version of a GMF file to write: binary files of versions 1 and 2 refer to
+  // keywords by 32-bit positions, so a file that may exceed 2 GB is written in version 3
+  static int GmfVersion( int version, const char* file, double nbBytes )
+  {
+    const size_t len = strlen( file );
+    const bool isBinary = ( len > 0 && file[ len - 1 ] == 'b' ); // .meshb or .solb
+    return ( isBinary && version < 3 && nbBytes > 2e9 ) ? 3 : version;
+  }
+
   // IN to MESHGEMS
   int  GmfOpenMesh(const char* theFile, int rdOrWr, int ver, int dim);
   void GmfSetKwd(int iMesh, GmfKwdCod what, int nb );
@@ -52,6 +74,11 @@ public:
   void GmfSetLin(int iMesh, GmfKwdCod what, int id ); // required
   void GmfSetLin(int iMesh, GmfKwdCod what, int node1, int node2, int node3, int domain ); // tria
   void GmfSetLin(int iMesh, GmfKwdCod what, int node1, int node2, int node3, int node4, int domain ); // tetra
+  void GmfSetBlock(int iMesh, GmfKwdCod what, const double* values, int nb ); // nodes or sol
+  void GmfSetBlock(int iMesh, GmfKwdCod what, const int* nodes, int nbNodesPerElem, int nb ); // elements or required
+  // data is moved to MG-Tetra as is in library mode (nodes must live until Compute() end)
+  void GmfSetBlock(int iMesh, GmfKwdCod what, std::vector<const SMDS_MeshNode*>&& nodes ); // nodes
+  void GmfSetBlock(int iMesh, GmfKwdCod what, std::vector<int>&& nodes, int nbNodesPerElem ); // elements
 
   bool Compute( const std::string& cmdLine, std::string& errStr );
 
@@ -59,14 +86,17 @@ public:
   int  GmfOpenMesh(const char* theFile, int rdOrWr, int * ver, int * dim);
   int  GmfStatKwd( int iMesh, GmfKwdCod what );
   void GmfGotoKwd( int iMesh, GmfKwdCod what );
-  void GmfGetLin( int iMesh, GmfKwdCod what, int* nbNodes, int* faceInd, int* ori, int* domain, int dummy );
-  void GmfGetLin(int iMesh, GmfKwdCod what, float* x, float* y, float *z, int* domain );
-  void GmfGetLin(int iMesh, GmfKwdCod what, double* x, double* y, double *z, int* domain );
-  void GmfGetLin(int iMesh, GmfKwdCod what, int* node );
-  void GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* domain );
-  void GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* domain );
-  void GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* node4, int* domain );
-  void GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* node4, int* node5, int* node6, int* node7, int* node8, int* domain );
+  // GmfGetLin() and GmfGetBlock() return false if the data is missing or corrupted
+  bool GmfGetLin( int iMesh, GmfKwdCod what, int* nbNodes, int* faceInd, int* ori, int* domain, int dummy );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, float* x, float* y, float *z, int* domain );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, double* x, double* y, double *z, int* domain );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, int* node );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* domain );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* domain );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* node4, int* domain );
+  bool GmfGetLin(int iMesh, GmfKwdCod what, int* node1, int* node2, int* node3, int* node4, int* node5, int* node6, int* node7, int* node8, int* domain );
+  bool GmfGetBlock(int iMesh, GmfKwdCod what, double* xyz, int nb ); // nodes
+  bool GmfGetBlock(int iMesh, GmfKwdCod what, int* nodes, int* domains, int nbNodesPerElem, int nb ); // elements
   void GmfCloseMesh( int iMesh );
 
   void SetLogFile( const std::string& logFileName ) { _logFile = logFileName; }
@@ -81,6 +111,8 @@ private:
   bool          _useLib;
   LibData*      _libData;
   std::set<int> _openFiles;
+  std::map<int,int> _fileVersion; // of files open for reading
+  std::map<int,MG_Tetra_GmfReader*> _readers; // of files mapped into memory, negative ids
   std::string   _logFile;
 
   // count mesh entities for MG license key generation
@@ -0,0 +1,361 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#include "MG_Tetra_Budget.hxx"
+
+#include <SMESH_Comment.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  //! Resources taken by a run of some process
+  struct TRecord
+  {
+    long   _pid;
+    long   _id;
+    int    _nbThreads;
+    size_t _memoryMB;
+  };
+
+  std::mutex              theMutex;    // serializes access to the state of the process
+  std::condition_variable theReleased; // notified when a grant of the process is released
+  std::vector< TRecord >  theRecords;  // grants of the process if the state file is unavailable
+  long                    theLastID = 0;
+
+  const int theWaitPeriodMS = 200; // period of checking resources freed by other processes
+
+  long currentPID()
+  {
+#ifndef WIN32
+    return (long) getpid();
+#else
+    return 0;
+#endif
+  }
+
+#ifndef WIN32
+
+  //================================================================================
+  /*!
+   * \brief Return path of the state file
+   */
+  //================================================================================
+
+  std::string stateFilePath()
+  {
+    if ( const char* path = getenv("MG_TETRA_BUDGET_FILE"))
+      return path;
+    if ( const char* dir = getenv("XDG_RUNTIME_DIR")) // private directory of the user
+      if ( dir[0] )
+        return std::string( dir ) + "/mg_tetra_budget";
+    return SMESH_Comment("/tmp/mg_tetra_budget_") << (long) getuid();
+  }
+
+  //================================================================================
+  /*!
+   * \brief State file exclusively locked during life of the object. The file is
+   *        not used if it is a symbolic link, is owned by another user or can be
+   *        written by others
+   */
+  //================================================================================
+
+  class TStateFile
+  {
+    int _fd;
+
+  public:
+
+    TStateFile()
+    {
+      _fd = ::open( stateFilePath().c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600 );
+      if ( _fd < 0 )
+        return;
+      struct stat st;
+      if ( ::fstat( _fd, &st ) != 0     ||
+           !S_ISREG( st.st_mode )       ||
+           st.st_uid != ::getuid()      ||
+           ( st.st_mode & ( S_IWGRP | S_IWOTH )) ||
+           ::flock( _fd, LOCK_EX ) != 0 )
+      {
+        ::close( _fd );
+        _fd = -1;
+      }
+    }
+    ~TStateFile()
+    {
+      if ( _fd >= 0 )
+      {
+        ::flock( _fd, LOCK_UN );
+        ::close( _fd );
+      }
+    }
+    bool IsOpen() const { return _fd >= 0; }
+
+    //! Read records of alive processes; a process of another user can only be
+    //! a dead process whose ID is reused
+    void Read( std::vector< TRecord >& records )
+    {
+      records.clear();
+
+      std::string text;
+      char buf[ 4096 ];
+      ::lseek( _fd, 0, SEEK_SET );
+      for ( ssize_t nb; ( nb = ::read( _fd, buf, sizeof( buf ))) != 0; )
+      {
+        if ( nb < 0 && errno == EINTR )
+          continue;
+        if ( nb < 0 )
+          break;
+        text.append( buf, nb );
+      }
+
+      std::istringstream lines( text );
+      TRecord r;
+      while ( lines >> r._pid >> r._id >> r._nbThreads >> r._memoryMB )
+        if ( ::kill( (pid_t) r._pid, 0 ) == 0 )
+          records.push_back( r );
+    }
+
+    //! Replace the file contents
+    void Write( const std::vector< TRecord >& records )
+    {
+      std::ostringstream text;
+      for ( size_t i = 0; i < records.size(); ++i )
+        text << records[i]._pid       << " "
+             << records[i]._id        << " "
+             << records[i]._nbThreads << " "
+             << records[i]._memoryMB  << "\n";
+
+      const std::string& data = text.str();
+      if ( ::ftruncate( _fd, 0 ) != 0 )
+        return;
+      ::lseek( _fd, 0, SEEK_SET );
+      for ( size_t written = 0; written < data.size(); )
+      {
+        ssize_t nb = ::write( _fd, data.data() + written, data.size() - written );
+        if ( nb < 0 && errno == EINTR )
+          continue;
+        if ( nb < 0 )
+          break;
+        written += nb;
+      }
+    }
+  };
+
+#endif
+
+  //================================================================================
+  /*!
+   * \brief Try to take resources from the budget. Called under theMutex
+   *  \return bool - true if grant is filled in
+   */
+  //================================================================================
+
+  bool tryAcquire( int nbThreads, size_t memoryMB,
+                   long& id, int& grantedThreads, size_t& grantedMemoryMB )
+  {
+    std::vector< TRecord > records;
+#ifndef WIN32
+    TStateFile file;
+    if ( file.IsOpen() )
+      file.Read( records );
+    else
+#endif
+      records = theRecords;
+
+    const int    totalThreads = MG_Tetra_Budget::TotalThreads();
+    const size_t totalMemory  = MG_Tetra_Budget::TotalMemoryMB();
+
+    int    usedThreads = 0;
+    size_t usedMemory  = 0;
+    for ( size_t i = 0; i < records.size(); ++i )
+    {
+      usedThreads += records[i]._nbThreads;
+      usedMemory  += records[i]._memoryMB;
+    }
+    const int    freeThreads = totalThreads - usedThreads;
+    const size_t freeMemory  = ( usedMemory < totalMemory ) ? totalMemory - usedMemory : 0;
+
+    nbThreads = std::max( 1, std::min( nbThreads, totalThreads ));
+    memoryMB  = std::min( memoryMB, totalMemory );
+
+    grantedThreads  = std::max( 1, std::min( nbThreads, freeThreads ));
+    grantedMemoryMB = std::min( memoryMB, freeMemory );
+
+    // a run waits for memory proportional to its share of cores (or for less if
+    // it asks for less) but takes all the free memory it asks for
+    const size_t coreShare = size_t( double( totalMemory ) * grantedThreads / totalThreads );
+    const size_t minMemory = std::min( memoryMB, coreShare );
+
+    if ( !records.empty() && ( freeThreads < 1 || freeMemory < minMemory ))
+      return false;
+
+    id = ++theLastID;
+
+    TRecord r;
+    r._pid       = currentPID();
+    r._id        = id;
+    r._nbThreads = grantedThreads;
+    r._memoryMB  = grantedMemoryMB;
+    records.push_back( r );
+
+#ifndef WIN32
+    if ( file.IsOpen() )
+      file.Write( records );
+    else
+#endif
+      theRecords = records;
+
+    return true;
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Wait until resources are free and take them
+ *  \param [in] nbThreads - number of threads a run wants
+ *  \param [in] memoryMB - memory a run wants; zero if unknown
+ *  \param [in] isCancelled - flag to stop waiting
+ *  \param [out] grant - the taken resources, maybe less than wanted ones
+ *  \return bool - false if cancelled
+ */
+//================================================================================
+
+bool MG_Tetra_Budget::Acquire( int            nbThreads,
+                               size_t         memoryMB,
+                               volatile bool* isCancelled,
+                               Grant&         grant )
+{
+  grant.Release();
+
+  std::unique_lock< std::mutex > lock( theMutex );
+
+  bool isWaiting = false;
+  while ( !tryAcquire( nbThreads, memoryMB, grant._id, grant._nbThreads, grant._memoryMB ))
+  {
+    if ( isCancelled && *isCancelled )
+      return false;
+    if ( !isWaiting )
+      std::cout << "MG-Tetra waits for free cores and memory..." << std::endl;
+    isWaiting = true;
+
+    theReleased.wait_for( lock, std::chrono::milliseconds( theWaitPeriodMS ));
+  }
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Return resources to the budget
+ */
+//================================================================================
+
+void MG_Tetra_Budget::Grant::Release()
+{
+  if ( !_id )
+    return;
+
+  std::lock_guard< std::mutex > lock( theMutex );
+
+  std::vector< TRecord > records;
+#ifndef WIN32
+  TStateFile file;
+  if ( file.IsOpen() )
+    file.Read( records );
+  else
+#endif
+    records = theRecords;
+
+  const long pid = currentPID();
+  for ( size_t i = 0; i < records.size(); ++i )
+    if ( records[i]._pid == pid && records[i]._id == _id )
+    {
+      records.erase( records.begin() + i );
+      break;
+    }
+
+#ifndef WIN32
+  if ( file.IsOpen() )
+    file.Write( records );
+  else
+#endif
+    theRecords = records;
+
+  _id = 0;
+  _nbThreads = 0;
+  _memoryMB = 0;
+
+  theReleased.notify_all();
+}
+
+//================================================================================
+/*!
+ * \brief Return number of threads shared by runs
+ */
+//================================================================================
+
+int MG_Tetra_Budget::TotalThreads()
+{
+  if ( const char* budget = getenv("MG_TETRA_THREAD_BUDGET"))
+    if ( atoi( budget ) > 0 )
+      return atoi( budget );
+
+  return std::max( 1, (int) std::thread::hardware_concurrency() );
+}
+
+//================================================================================
+/*!
+ * \brief Return memory (MB) shared by runs
+ */
+//================================================================================
+
+size_t MG_Tetra_Budget::TotalMemoryMB()
+{
+  if ( const char* budget = getenv("MG_TETRA_MEMORY_BUDGET"))
+    if ( atol( budget ) > 0 )
+      return (size_t) atol( budget );
+
+#ifndef WIN32
+  const long nbPages  = sysconf( _SC_PHYS_PAGES );
+  const long pageSize = sysconf( _SC_PAGE_SIZE );
+  if ( nbPages > 0 && pageSize > 0 )
+    return (size_t)( 0.7 * double( nbPages ) * double( pageSize ) / 1024. / 1024. );
+#endif
+  return std::numeric_limits< size_t >::max() / 2;
+}
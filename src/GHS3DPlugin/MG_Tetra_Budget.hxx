@@ -0,0 +1,74 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#ifndef __MG_Tetra_Budget_HXX__
+#define __MG_Tetra_Budget_HXX__
+
+#include <cstddef>
+
+/*!
+ * \brief Budget of processor cores and memory shared by MG-Tetra runs of a host.
+ *
+ * A run takes a Grant of threads and memory before starting and returns it at
+ * the end. Grants of all processes are recorded in a state file locked by
+ * flock(): MG_TETRA_BUDGET_FILE environment variable, else a file in
+ * XDG_RUNTIME_DIR or a per-user file in /tmp. If the file is not a regular file
+ * of the user, grants are shared by runs of the process only. The budget is the
+ * number of processor cores and 70% of RAM, unless MG_TETRA_THREAD_BUDGET and
+ * MG_TETRA_MEMORY_BUDGET (MB) environment variables are set. Records of dead
+ * processes are dropped.
+ */
+class MG_Tetra_Budget
+{
+public:
+
+  //! Resources taken by a run; they are returned to the budget at destruction
+  class Grant
+  {
+  public:
+    Grant(): _id( 0 ), _nbThreads( 0 ), _memoryMB( 0 ) {}
+    ~Grant() { Release(); }
+
+    void   Release();
+    bool   IsValid()   const { return _id != 0; }
+    int    NbThreads() const { return _nbThreads; }
+    size_t MemoryMB()  const { return _memoryMB; }
+
+  private:
+    Grant( const Grant& );
+    Grant& operator=( const Grant& );
+
+    long   _id;
+    int    _nbThreads;
+    size_t _memoryMB;
+
+    friend class MG_Tetra_Budget;
+  };
+
+  //! Wait until resources are free and take them. Return false if cancelled
+  static bool Acquire( int            nbThreads,
+                       size_t         memoryMB,
+                       volatile bool* isCancelled,
+                       Grant&         grant );
+
+  static int    TotalThreads();
+  static size_t TotalMemoryMB();
+};
+
+#endif
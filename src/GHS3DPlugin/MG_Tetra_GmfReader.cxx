@@ -0,0 +1,631 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#include "MG_Tetra_GmfReader.hxx"
+
+#include <SMESH_File.hxx>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+
+#include <locale.h>
+
+namespace
+{
+  //================================================================================
+  /*!
+   * \brief Description of keywords read by the plugin
+   */
+  //================================================================================
+
+  struct TKeywordDesc
+  {
+    GmfKwdCod   _kwd;
+    const char* _name;
+    int         _nbInts; // nb of integers per line
+  };
+
+  const TKeywordDesc theKeywords[] =
+    {
+      { GmfVertices,          "Vertices",          1 }, // + Dimension reals
+      { GmfEdges,             "Edges",             3 },
+      { GmfTriangles,         "Triangles",         4 },
+      { GmfQuadrilaterals,    "Quadrilaterals",    5 },
+      { GmfTetrahedra,        "Tetrahedra",        5 },
+      { GmfHexahedra,         "Hexahedra",         9 },
+      { GmfCorners,           "Corners",           1 },
+      { GmfRidges,            "Ridges",            1 },
+      { GmfRequiredVertices,  "RequiredVertices",  1 },
+      { GmfRequiredEdges,     "RequiredEdges",     1 },
+      { GmfRequiredTriangles, "RequiredTriangles", 1 },
+      { GmfSubDomainFromGeom, "SubDomainFromGeom", 4 }
+    };
+  const int theNbKeywords = sizeof( theKeywords ) / sizeof( TKeywordDesc );
+
+  const TKeywordDesc* findKeyword( int kwd )
+  {
+    for ( int i = 0; i < theNbKeywords; ++i )
+      if ( theKeywords[i]._kwd == kwd )
+        return & theKeywords[i];
+    return 0;
+  }
+
+  const TKeywordDesc* findKeyword( const char* name, size_t len )
+  {
+    for ( int i = 0; i < theNbKeywords; ++i )
+      if ( strlen( theKeywords[i]._name ) == len &&
+           strncmp( theKeywords[i]._name, name, len ) == 0 )
+        return & theKeywords[i];
+    return 0;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Return a value stored at a given address, possibly with reversed bytes
+   */
+  //================================================================================
+
+  template< typename T >
+  inline T getValue( const char* ptr, bool swap )
+  {
+    T value;
+    if ( swap )
+    {
+      char* bytes = (char*) &value;
+      for ( size_t i = 0; i < sizeof( T ); ++i )
+        bytes[i] = ptr[ sizeof( T ) - 1 - i ];
+    }
+    else
+    {
+      std::memcpy( &value, ptr, sizeof( T ));
+    }
+    return value;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Return an integer of a file as int. A value out of the int range, possible
+   *        in version 4, becomes INT_MIN, which is invalid as a node ID or a domain
+   */
+  //================================================================================
+
+  inline int toInt( long long value )
+  {
+    return ( value < INT_MIN || value > INT_MAX ) ? INT_MIN : int( value );
+  }
+
+  // ASCII parsing
+
+  //! Skip white spaces and comments; return false at the end of data
+  inline bool skipSpaces( const char* & p, const char* end )
+  {
+    while ( p < end )
+    {
+      if ( *p == '#' )
+      {
+        while ( p < end && *p != '\n' ) ++p;
+      }
+      else if ( isspace( (unsigned char) *p ))
+      {
+        ++p;
+      }
+      else
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline bool parseInt( const char* & p, const char* end, long long & value )
+  {
+    if ( !skipSpaces( p, end ))
+      return false;
+    bool negative = false;
+    if ( *p == '-' || *p == '+' )
+      negative = ( *p++ == '-' );
+    if ( p == end || !isdigit( (unsigned char) *p ))
+      return false;
+    value = 0;
+    while ( p < end && isdigit( (unsigned char) *p ))
+    {
+      if ( value > ( LLONG_MAX - 9 ) / 10 ) // overflow
+        return false;
+      value = 10 * value + ( *p++ - '0' );
+    }
+    if ( negative )
+      value = -value;
+    return true;
+  }
+
+  //! Return the "C" locale; reals are read in it whatever the global locale is,
+  //! which can't be changed while other threads may work
+#ifdef WIN32
+  _locale_t cLocale()
+  {
+    static _locale_t loc = _create_locale( LC_NUMERIC, "C" );
+    return loc;
+  }
+#else
+  locale_t cLocale()
+  {
+    static locale_t loc = newlocale( LC_NUMERIC_MASK, "C", (locale_t) 0 );
+    return loc;
+  }
+#endif
+
+  inline bool parseReal( const char* & p, const char* end, double & value )
+  {
+    if ( !skipSpaces( p, end ))
+      return false;
+    char buf[ 64 ];
+    size_t len = 0;
+    while ( p + len < end && len < sizeof( buf ) - 1 && !isspace( (unsigned char) p[len] ))
+      ++len;
+    std::memcpy( buf, p, len );
+    buf[ len ] = '\0';
+    char* bufEnd;
+#ifdef WIN32
+    value = _strtod_l( buf, &bufEnd, cLocale() );
+#else
+    value = strtod_l( buf, &bufEnd, cLocale() );
+#endif
+    if ( bufEnd == buf )
+      return false;
+    p += len;
+    return true;
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Return i-th value
+ */
+//================================================================================
+
+template< typename T >
+T MG_Tetra_GmfReader::TStridedView<T>::operator[]( size_t i ) const
+{
+  return getValue< T >( _ptr + i * _stride, _swap );
+}
+
+//================================================================================
+/*!
+ * \brief Constructor
+ */
+//================================================================================
+
+MG_Tetra_GmfReader::MG_Tetra_GmfReader():
+  _begin(0), _end(0), _file(0), _version(0), _dim(0), _realSize(0), _intSize(0),
+  _swap(false), _curKwd(0), _cur(0), _curLine(0)
+{
+}
+
+//================================================================================
+/*!
+ * \brief Destructor
+ */
+//================================================================================
+
+MG_Tetra_GmfReader::~MG_Tetra_GmfReader()
+{
+  Close();
+}
+
+//================================================================================
+/*!
+ * \brief Map a file into memory and index its keywords
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::Open( const std::string& fileName )
+{
+  Close();
+
+  _file = new SMESH_File( fileName, /*openForReading=*/false );
+  if ( !_file->open() || _file->size() <= 0 )
+  {
+    Close();
+    return false;
+  }
+  _begin = _file->getPos();
+  _end   = _file->end();
+
+  if ( !index() )
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Index keywords of GMF data residing in memory
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::Open( const char* data, size_t size )
+{
+  Close();
+
+  _begin = data;
+  _end   = data + size;
+
+  if ( !index() )
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Unmap the file
+ */
+//================================================================================
+
+void MG_Tetra_GmfReader::Close()
+{
+  delete _file;
+  _file    = 0;
+  _begin   = _end = _cur = 0;
+  _version = _dim = _realSize = _intSize = 0;
+  _swap    = false;
+  _curKwd  = 0;
+  _curLine = 0;
+  _keywords.clear();
+}
+
+//================================================================================
+/*!
+ * \brief Return nb of lines of a keyword
+ */
+//================================================================================
+
+int MG_Tetra_GmfReader::NbLines( GmfKwdCod what ) const
+{
+  std::map< int, TKeyword >::const_iterator k = _keywords.find( what );
+  return k == _keywords.end() ? 0 : k->second._nbLines;
+}
+
+//================================================================================
+/*!
+ * \brief Prepare for reading lines of a keyword
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::GotoKwd( GmfKwdCod what )
+{
+  std::map< int, TKeyword >::const_iterator k = _keywords.find( what );
+  if ( k == _keywords.end() )
+  {
+    _curKwd = 0;
+    return false;
+  }
+  _curKwd  = & k->second;
+  _cur     = _curKwd->_data;
+  _curLine = 0;
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Read coordinates and references of next vertices
+ *  \param [out] xyz - array of 3 * nb coordinates
+ *  \param [out] domains - array of nb references; can be NULL
+ *  \param [in] nb - nb of vertices to read
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::GetVertices( double* xyz, int* domains, int nb )
+{
+  if ( !_curKwd || _curLine + nb > _curKwd->_nbLines )
+    return false;
+
+  if ( isBinary() )
+  {
+    const size_t recSize = _dim * _realSize + _intSize;
+    if ( _realSize == 8 && _intSize == 4 && !_swap && _dim == 3 && !domains )
+    {
+      for ( int i = 0; i < nb; ++i, xyz += 3, _cur += recSize )
+        std::memcpy( xyz, _cur, 3 * sizeof( double ));
+    }
+    else
+    {
+      for ( int iC = 0; iC < 3; ++iC )
+      {
+        if ( iC >= _dim )
+        {
+          for ( int i = 0; i < nb; ++i )
+            xyz[ 3 * i + iC ] = 0.;
+        }
+        else if ( _realSize == 8 )
+        {
+          TStridedView< double > coord = { _cur + iC * _realSize, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            xyz[ 3 * i + iC ] = coord[ i ];
+        }
+        else
+        {
+          TStridedView< float > coord = { _cur + iC * _realSize, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            xyz[ 3 * i + iC ] = coord[ i ];
+        }
+      }
+      if ( domains )
+      {
+        const char* refPtr = _cur + _dim * _realSize;
+        if ( _intSize == 8 )
+        {
+          TStridedView< long long > ref = { refPtr, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            domains[ i ] = toInt( ref[ i ]);
+        }
+        else
+        {
+          TStridedView< int > ref = { refPtr, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            domains[ i ] = ref[ i ];
+        }
+      }
+      _cur += nb * recSize;
+    }
+  }
+  else // ASCII
+  {
+    long long ref;
+    for ( int i = 0; i < nb; ++i, xyz += 3 )
+    {
+      xyz[2] = 0.;
+      for ( int iC = 0; iC < _dim; ++iC )
+        if ( !parseReal( _cur, _end, xyz[ iC ]))
+          return false;
+      if ( !parseInt( _cur, _end, ref ))
+        return false;
+      if ( domains )
+        domains[ i ] = toInt( ref );
+    }
+  }
+  _curLine += nb;
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Read nodes and references of next elements
+ *  \param [out] nodes - array of nbNodesPerElem * nb node indices
+ *  \param [out] domains - array of nb references; can be NULL
+ *  \param [in] nbNodesPerElem - nb of nodes of an element of the current keyword
+ *  \param [in] nb - nb of elements to read
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::GetElements( int* nodes, int* domains, int nbNodesPerElem, int nb )
+{
+  if ( !_curKwd || _curLine + nb > _curKwd->_nbLines || nbNodesPerElem > _curKwd->_nbInts )
+    return false;
+
+  const int nbInts = _curKwd->_nbInts;
+  if ( nbInts == nbNodesPerElem )
+    domains = 0; // no references in data
+
+  if ( isBinary() )
+  {
+    const size_t recSize = nbInts * _intSize;
+    if ( _intSize == 4 && !_swap )
+    {
+      const size_t nodesSize = nbNodesPerElem * sizeof( int );
+      for ( int i = 0; i < nb; ++i, nodes += nbNodesPerElem, _cur += recSize )
+      {
+        std::memcpy( nodes, _cur, nodesSize );
+        if ( domains )
+          std::memcpy( domains + i, _cur + nodesSize, sizeof( int ));
+      }
+    }
+    else
+    {
+      const int nbColumns = nbNodesPerElem + ( domains ? 1 : 0 );
+      for ( int iC = 0; iC < nbColumns; ++iC )
+      {
+        int* values = ( iC < nbNodesPerElem ) ? nodes + iC : domains;
+        int  step   = ( iC < nbNodesPerElem ) ? nbNodesPerElem : 1;
+        if ( _intSize == 8 )
+        {
+          TStridedView< long long > column = { _cur + iC * _intSize, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            values[ i * step ] = toInt( column[ i ]);
+        }
+        else
+        {
+          TStridedView< int > column = { _cur + iC * _intSize, recSize, _swap };
+          for ( int i = 0; i < nb; ++i )
+            values[ i * step ] = column[ i ];
+        }
+      }
+      _cur += nb * recSize;
+    }
+  }
+  else // ASCII
+  {
+    long long value;
+    for ( int i = 0; i < nb; ++i )
+      for ( int iC = 0; iC < nbInts; ++iC )
+      {
+        if ( !parseInt( _cur, _end, value ))
+          return false;
+        if ( iC < nbNodesPerElem )
+          *nodes++ = toInt( value );
+        else if ( iC == nbNodesPerElem && domains )
+          domains[ i ] = toInt( value );
+      }
+  }
+  _curLine += nb;
+  return true;
+}
+
+//================================================================================
+/*!
+ * \brief Read next lines of integers
+ *  \param [out] values - array of nbPerLine * nb values
+ *  \param [in] nbPerLine - nb of values per line
+ *  \param [in] nb - nb of lines
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::GetIntegers( int* values, int nbPerLine, int nb )
+{
+  return GetElements( values, /*domains=*/0, nbPerLine, nb );
+}
+
+//================================================================================
+/*!
+ * \brief Find positions and sizes of keywords
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::index()
+{
+  _keywords.clear();
+  if ( _end - _begin < 8 )
+    return false;
+
+  int code;
+  std::memcpy( &code, _begin, sizeof( int ));
+  if ( code == 1 || code == 16777216 )
+  {
+    _swap = ( code != 1 );
+    return indexBinary();
+  }
+  return indexAscii();
+}
+
+//================================================================================
+/*!
+ * \brief Index keywords of a binary file
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::indexBinary()
+{
+  _version = getValue< int >( _begin + 4, _swap );
+  if ( _version < 1 || _version > 4 )
+    return false;
+
+  _realSize = ( _version == 1 ) ? 4 : 8;
+  _intSize  = ( _version == 4 ) ? 8 : 4;
+  const int posSize = ( _version >= 3 ) ? 8 : 4;
+  const long long fileSize = _end - _begin;
+
+  const char* p = _begin + 8;
+  while ( p + 4 + posSize <= _end )
+  {
+    const int kwd = getValue< int >( p, _swap );
+    p += 4;
+    long long nextPos = ( posSize == 8 ) ? getValue< long long >( p, _swap ) : getValue< int >( p, _swap );
+    p += posSize;
+
+    if ( kwd == GmfEnd )
+      break;
+
+    if ( kwd == GmfDimension )
+    {
+      if ( p + 4 > _end )
+        return false;
+      _dim = getValue< int >( p, _swap );
+    }
+    else if ( const TKeywordDesc* desc = findKeyword( kwd ))
+    {
+      if ( p + _intSize > _end )
+        return false;
+      long long nbLines = ( _intSize == 8 ) ? getValue< long long >( p, _swap ) : getValue< int >( p, _swap );
+      TKeyword& k = _keywords[ kwd ];
+      k._data    = p + _intSize;
+      k._nbLines = (int) nbLines;
+      k._nbInts  = desc->_nbInts;
+      size_t recSize = desc->_nbInts * _intSize + ( kwd == GmfVertices ? _dim * _realSize : 0 );
+      if ( nbLines < 0 || nbLines > INT_MAX || nbLines * recSize > size_t( _end - k._data ))
+        return false;
+    }
+    if ( nextPos <= p - _begin || nextPos >= fileSize )
+      break;
+    p = _begin + nextPos;
+  }
+  return _dim == 2 || _dim == 3;
+}
+
+//================================================================================
+/*!
+ * \brief Index keywords of an ASCII file
+ */
+//================================================================================
+
+bool MG_Tetra_GmfReader::indexAscii()
+{
+  _intSize = 0;
+  const char* p = _begin;
+  while ( p < _end )
+  {
+    // keywords start a line with a letter, data lines start with a number
+    while ( p < _end && ( *p == ' ' || *p == '\t' || *p == '\r' )) ++p;
+    if ( p < _end && isalpha( (unsigned char) *p ))
+    {
+      const char* word = p;
+      while ( p < _end && isalnum( (unsigned char) *p )) ++p;
+      const size_t len = p - word;
+      long long value;
+
+      if ( len == 3 && strncmp( word, "End", 3 ) == 0 )
+        break;
+      if ( len == 20 && strncmp( word, "MeshVersionFormatted", 20 ) == 0 )
+      {
+        if ( !parseInt( p, _end, value ))
+          return false;
+        _version = (int) value;
+      }
+      else if ( len == 9 && strncmp( word, "Dimension", 9 ) == 0 )
+      {
+        if ( !parseInt( p, _end, value ))
+          return false;
+        _dim = (int) value;
+      }
+      else if ( const TKeywordDesc* desc = findKeyword( word, len ))
+      {
+        if ( !parseInt( p, _end, value ))
+          return false;
+        // a line holds at least as many values as columns, each followed by a space
+        const long long nbColumns = desc->_nbInts + ( desc->_kwd == GmfVertices ? _dim : 0 );
+        if ( value < 0 || value > INT_MAX || value * nbColumns * 2 > _end - p )
+          return false;
+        TKeyword& k = _keywords[ desc->_kwd ];
+        k._data    = p;
+        k._nbLines = (int) value;
+        k._nbInts  = desc->_nbInts;
+      }
+    }
+    const char* eol = (const char*) memchr( p, '\n', _end - p );
+    p = eol ? eol + 1 : _end;
+  }
+  return _dim == 2 || _dim == 3;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#ifndef __MG_Tetra_GmfReader_HXX__
+#define __MG_Tetra_GmfReader_HXX__
+
+#include "MG_Tetra_API.hxx" // libmesh5.h
+
+#include <map>
+#include <string>
+
+class SMESH_File;
+
+/*!
+ * \brief Reader of GMF files (.mesh and .meshb) written by MG-Tetra executable.
+ *
+ * The file is mapped into memory and indexed at opening; then data of keywords
+ * are copied into arrays of the caller right from the mapped memory, without
+ * going through stdio. Binary files of versions 1 to 4 of both endiannesses
+ * are supported. Only keywords read by the plugin are indexed.
+ */
+class MG_Tetra_GmfReader
+{
+public:
+
+  MG_Tetra_GmfReader();
+  ~MG_Tetra_GmfReader();
+
+  bool Open( const std::string& fileName );
+  bool Open( const char* data, size_t size ); // parse data owned by the caller
+  void Close();
+
+  int  Version()   const { return _version; }
+  int  Dimension() const { return _dim; }
+
+  int  NbLines( GmfKwdCod what ) const;
+  bool GotoKwd( GmfKwdCod what );
+
+  // Read next lines of the current keyword
+  bool GetVertices( double* xyz, int* domains, int nb );
+  bool GetElements( int* nodes, int* domains, int nbNodesPerElem, int nb );
+  bool GetIntegers( int* values, int nbPerLine, int nb ); // e.g. SubDomainFromGeom
+
+  /*!
+   * \brief A typed view of one value of successive fixed-size records
+   */
+  template< typename T > struct TStridedView
+  {
+    const char* _ptr;
+    size_t      _stride;
+    bool        _swap;
+
+    T operator[]( size_t i ) const;
+  };
+
+private:
+
+  struct TKeyword
+  {
+    const char* _data;   // first line
+    int         _nbLines;
+    int         _nbInts; // nb of integers per line (+ _dim reals for vertices)
+  };
+
+  bool index();
+  bool indexBinary();
+  bool indexAscii();
+  bool isBinary() const { return _intSize > 0; }
+
+  const char* _begin;
+  const char* _end;
+  SMESH_File* _file;
+
+  int         _version;
+  int         _dim;
+  int         _realSize; // in binary file
+  int         _intSize;  // in binary file, 0 for an ASCII file
+  bool        _swap;     // binary file of another endianness
+
+  std::map< int, TKeyword > _keywords;
+
+  const TKeyword* _curKwd;
+  const char*     _cur;     // position of the next line to read
+  int             _curLine; // index of the next line to read
+};
+
+#endif
@@ -0,0 +1,449 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#include "MG_Tetra_Process.hxx"
+
+#include <SMESH_Comment.hxx>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef WIN32
+#include <chrono>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifndef WIN32
+
+  //================================================================================
+  /*!
+   * \brief Return a path to an executable found in PATH
+   */
+  //================================================================================
+
+  std::string findExecutable( const std::string& name )
+  {
+    const char* path = getenv("PATH");
+    if ( !path || name.find('/') != std::string::npos )
+      return name;
+
+    const std::string dirs = path;
+    for ( size_t start = 0, end; start <= dirs.size(); start = end + 1 )
+    {
+      end = dirs.find( ':', start );
+      if ( end == std::string::npos )
+        end = dirs.size();
+      std::string file = ( end > start ) ? dirs.substr( start, end - start ) : std::string(".");
+      file += "/" + name;
+      if ( ::access( file.c_str(), X_OK ) == 0 )
+        return file;
+    }
+    return name;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Create a pipe whose ends are closed on exec
+   */
+  //================================================================================
+
+  bool makePipe( int fds[2] )
+  {
+    // O_CLOEXEC is set atomically, else another thread may fork() and exec()
+    // between pipe() and fcntl() and pass the pipe to an unrelated process
+    return ::pipe2( fds, O_CLOEXEC ) == 0;
+  }
+
+  //================================================================================
+  /*!
+   * \brief Output stream of the child read through a pipe
+   */
+  //================================================================================
+
+  struct TChildOutput
+  {
+    int         _pipe; // read end of the pipe, -1 when closed
+    int         _fd;   // where the output goes
+    std::string _line; // incomplete line passed to a listener
+    std::string _tail; // last output, for an error message
+
+    TChildOutput( int pipe, int fd ): _pipe( pipe ), _fd( fd )
+    {
+      ::fcntl( _pipe, F_SETFL, ::fcntl( _pipe, F_GETFL ) | O_NONBLOCK );
+    }
+
+    //! Read all available data. Close the pipe at end of file
+    void Read( MG_Tetra_Process::LineListener* listener )
+    {
+      char buf[ 1 << 16 ];
+      while ( _pipe >= 0 )
+      {
+        ssize_t nb = ::read( _pipe, buf, sizeof( buf ));
+        if ( nb < 0 && errno == EINTR )
+          continue;
+        if ( nb < 0 ) // EAGAIN
+          return;
+        if ( nb == 0 )
+        {
+          Close( listener );
+          return;
+        }
+        for ( ssize_t written = 0, w; written < nb; written += w )
+          if (( w = ::write( _fd, buf + written, nb - written )) < 0 )
+          {
+            if ( errno != EINTR )
+              break;
+            w = 0;
+          }
+
+        _tail.append( buf, nb );
+        if ( _tail.size() > 4096 )
+          _tail.erase( 0, _tail.size() - 2048 );
+
+        if ( !listener )
+          continue;
+        for ( ssize_t i = 0; i < nb; ++i )
+        {
+          if ( buf[i] == '\n' )
+          {
+            listener->OnLine( _line );
+            _line.clear();
+          }
+          else
+          {
+            _line += buf[i];
+          }
+        }
+      }
+    }
+
+    void Close( MG_Tetra_Process::LineListener* listener )
+    {
+      if ( _pipe < 0 )
+        return;
+      ::close( _pipe );
+      _pipe = -1;
+      if ( listener && !_line.empty() )
+        listener->OnLine( _line );
+      _line.clear();
+    }
+  };
+
+#endif
+}
+
+//================================================================================
+/*!
+ * \brief Constructor
+ */
+//================================================================================
+
+MG_Tetra_Process::MG_Tetra_Process():
+  _isCancelled( 0 ), _listener( 0 ), _memoryLimitMB( 0 ), _killDelayMS( 3000 ),
+  _exitCode( -1 ), _signal( 0 ), _isKilled( false )
+{
+}
+
+//================================================================================
+/*!
+ * \brief Split a command line into arguments and output redirections.
+ *        Quotes group words into one argument.
+ *  \param [in] cmdLine - the command line
+ *  \param [out] args - the program and its arguments
+ *  \param [out] outFile - file of "1>file" redirection
+ *  \param [out] errFile - file of "2>file" redirection, "&1" for "2>&1"
+ */
+//================================================================================
+
+void MG_Tetra_Process::SplitCommand( const std::string&          cmdLine,
+                                     std::vector< std::string >& args,
+                                     std::string&                outFile,
+                                     std::string&                errFile )
+{
+  args.clear();
+  outFile.clear();
+  errFile.clear();
+
+  std::vector< std::string > words;
+  std::string word;
+  bool isWord = false;
+  char quote  = 0;
+  for ( size_t i = 0; i < cmdLine.size(); ++i )
+  {
+    const char c = cmdLine[i];
+    if ( quote )
+    {
+      if ( c == quote ) quote = 0;
+      else              word += c;
+    }
+    else if ( c == '"' || c == '\'' )
+    {
+      quote  = c;
+      isWord = true;
+    }
+    else if ( isspace( c ))
+    {
+      if ( isWord )
+        words.push_back( word );
+      word.clear();
+      isWord = false;
+    }
+    else
+    {
+      word  += c;
+      isWord = true;
+    }
+  }
+  if ( isWord )
+    words.push_back( word );
+
+  for ( size_t i = 0; i < words.size(); ++i )
+  {
+    std::string* file = 0;
+    size_t       len  = 0;
+    if      ( words[i].compare( 0, 2, "1>" ) == 0 ) { file = &outFile; len = 2; }
+    else if ( words[i].compare( 0, 1, ">"  ) == 0 ) { file = &outFile; len = 1; }
+    else if ( words[i].compare( 0, 2, "2>" ) == 0 ) { file = &errFile; len = 2; }
+    if ( !file )
+    {
+      args.push_back( words[i] );
+    }
+    else if ( words[i].size() > len )
+    {
+      *file = words[i].substr( len );
+    }
+    else if ( i + 1 < words.size() )
+    {
+      *file = words[++i];
+    }
+  }
+}
+
+//================================================================================
+/*!
+ * \brief Run a command and wait for its end
+ *  \param [in] cmdLine - the command with optional "1>file" and "2>file" redirections
+ *  \param [out] errStr - error description
+ *  \return bool - true if the process exits with zero status
+ */
+//================================================================================
+
+bool MG_Tetra_Process::Run( const std::string& cmdLine, std::string& errStr )
+{
+  _exitCode = -1;
+  _signal   = 0;
+  _isKilled = false;
+
+  std::vector< std::string > args;
+  std::string outFile, errFile;
+  SplitCommand( cmdLine, args, outFile, errFile );
+  if ( args.empty() )
+  {
+    errStr = "Empty command";
+    return false;
+  }
+
+#ifdef WIN32
+
+  int err = system( cmdLine.c_str() ); // run
+  _exitCode = err;
+  if ( err )
+    errStr = SMESH_Comment("system(") << args[0] << " ...) command failed with error: " << err;
+  return !err;
+
+#else
+
+  // prepare everything before fork(), as only async-signal-safe calls may be
+  // done in a child of a multi-threaded process
+
+  const std::string exe = findExecutable( args[0] );
+  std::vector< char* > argv;
+  for ( size_t i = 0; i < args.size(); ++i )
+    argv.push_back( const_cast< char* >( args[i].c_str() ));
+  argv.push_back( 0 );
+
+  int outFD = STDOUT_FILENO, errFD = STDERR_FILENO;
+  if ( !outFile.empty() &&
+       ( outFD = ::open( outFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666 )) < 0 )
+  {
+    errStr = SMESH_Comment("Can't write into ") << outFile;
+    return false;
+  }
+  if ( errFile == "&1" )
+    errFD = outFD;
+  else if ( !errFile.empty() &&
+            ( errFD = ::open( errFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666 )) < 0 )
+  {
+    if ( outFD != STDOUT_FILENO ) ::close( outFD );
+    errStr = SMESH_Comment("Can't write into ") << errFile;
+    return false;
+  }
+
+  int outPipe[2] = { -1, -1 }, errPipe[2] = { -1, -1 }, execPipe[2] = { -1, -1 };
+  if ( !makePipe( outPipe ) || !makePipe( errPipe ) || !makePipe( execPipe ))
+  {
+    errStr = SMESH_Comment("Can't create a pipe: ") << strerror( errno );
+    int fds[] = { outPipe[0], outPipe[1], errPipe[0], errPipe[1], execPipe[0], execPipe[1] };
+    for ( int i = 0; i < 6; ++i )
+      if ( fds[i] >= 0 ) ::close( fds[i] );
+    if ( outFD != STDOUT_FILENO ) ::close( outFD );
+    if ( errFD != STDERR_FILENO && errFD != outFD ) ::close( errFD );
+    return false;
+  }
+
+  struct rlimit memLimit;
+  memLimit.rlim_cur = memLimit.rlim_max = rlim_t( _memoryLimitMB ) * 1024 * 1024;
+
+  const pid_t pid = ::fork();
+  if ( pid == 0 ) // child
+  {
+    ::setpgid( 0, 0 ); // own process group to be killed along with its children
+    ::dup2( outPipe[1], STDOUT_FILENO );
+    ::dup2( errPipe[1], STDERR_FILENO );
+    if ( _memoryLimitMB > 0 )
+      ::setrlimit( RLIMIT_AS, &memLimit );
+    ::execv( exe.c_str(), &argv[0] );
+    int err = errno; // exec failed; report errno to the parent
+    ssize_t nb = ::write( execPipe[1], &err, sizeof( err ));
+    (void) nb;
+    ::_exit( 127 );
+  }
+  int forkErr = errno;
+  ::close( outPipe[1] );
+  ::close( errPipe[1] );
+  ::close( execPipe[1] );
+
+  int execErr = 0;
+  ssize_t nbErr = -1;
+  if ( pid > 0 )
+  {
+    ::setpgid( pid, pid ); // avoid a race with setpgid() of the child
+    // execPipe is closed by a successful exec, else errno is written to it
+    while (( nbErr = ::read( execPipe[0], &execErr, sizeof( execErr ))) < 0 && errno == EINTR );
+  }
+  ::close( execPipe[0] );
+
+  TChildOutput out( outPipe[0], outFD ), err( errPipe[0], errFD );
+
+  if ( pid < 0 || nbErr > 0 )
+  {
+    if ( pid < 0 )
+      errStr = SMESH_Comment("Can't run ") << args[0] << ": " << strerror( forkErr );
+    else
+      errStr = SMESH_Comment("Can't run ") << exe << ": " << strerror( execErr );
+    if ( pid > 0 )
+      ::waitpid( pid, 0, 0 );
+    out.Close( 0 );
+    err.Close( 0 );
+    if ( outFD != STDOUT_FILENO ) ::close( outFD );
+    if ( errFD != STDERR_FILENO && errFD != outFD ) ::close( errFD );
+    return false;
+  }
+
+  // read the output until the child exits; terminate it on cancellation
+
+  typedef std::chrono::steady_clock TClock;
+  TClock::time_point termTime;
+  bool isRunning = true, isTerminated = false, isKilled = false;
+  int  status = 0, waitErr = 0;
+  while ( isRunning )
+  {
+    pollfd pfd[2];
+    int    nbFD = 0;
+    if ( out._pipe >= 0 ) { pfd[ nbFD ].fd = out._pipe; pfd[ nbFD ].events = POLLIN; ++nbFD; }
+    if ( err._pipe >= 0 ) { pfd[ nbFD ].fd = err._pipe; pfd[ nbFD ].events = POLLIN; ++nbFD; }
+    ::poll( pfd, nbFD, /*timeout=*/100 );
+
+    out.Read( _listener );
+    err.Read( 0 );
+
+    pid_t res = ::waitpid( pid, &status, WNOHANG );
+    if ( res == pid || ( res < 0 && errno != EINTR ))
+    {
+      isRunning = false;
+      if ( res < 0 ) // ECHILD if SIGCHLD is ignored by the parent
+        waitErr = errno;
+      // children of the child may keep the pipes open; read what is already written
+      out.Read( _listener );
+      err.Read( 0 );
+    }
+    else if ( _isCancelled && *_isCancelled )
+    {
+      if ( !isTerminated )
+      {
+        ::kill( -pid, SIGTERM );
+        termTime     = TClock::now();
+        isTerminated = true;
+        _isKilled    = true;
+      }
+      else if ( !isKilled &&
+                TClock::now() - termTime > std::chrono::milliseconds( _killDelayMS ))
+      {
+        ::kill( -pid, SIGKILL );
+        isKilled = true;
+      }
+    }
+  }
+  out.Close( _listener );
+  err.Close( 0 );
+  if ( outFD != STDOUT_FILENO ) ::close( outFD );
+  if ( errFD != STDERR_FILENO && errFD != outFD ) ::close( errFD );
+
+  if ( waitErr == ECHILD && !_isKilled )
+  {
+    // SIGCHLD is ignored, so the system has reaped the child and its exit status is
+    // lost; a failed run is detected by absence or corruption of its result files
+    std::cout << "Warning: can't get exit status of " << args[0] << ": "
+              << strerror( waitErr ) << std::endl;
+    return true;
+  }
+  if ( waitErr )
+  {
+    errStr = SMESH_Comment("Can't get exit status of ") << args[0] << ": " << strerror( waitErr );
+    return false;
+  }
+  if ( WIFEXITED( status ))
+  {
+    _exitCode = WEXITSTATUS( status );
+    if ( _exitCode != 0 )
+      errStr = SMESH_Comment( args[0] ) << " exited with code " << _exitCode;
+  }
+  else if ( WIFSIGNALED( status ))
+  {
+    _signal = WTERMSIG( status );
+    errStr = SMESH_Comment( args[0] ) << " was terminated by signal " << _signal;
+  }
+  if ( !errStr.empty() && !err._tail.empty() )
+    errStr += ": " + err._tail;
+
+  return _exitCode == 0;
+
+#endif
+}
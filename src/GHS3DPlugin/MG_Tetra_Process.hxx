@@ -0,0 +1,80 @@
+// Copyright (C) 2004-2024  CEA, EDF
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+//
+// See http://www.salome-platform.org/ or email : webmaster.salome@opencascade.com
+//
+
+#ifndef __MG_Tetra_Process_HXX__
+#define __MG_Tetra_Process_HXX__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Supervisor of a child process running MG-Tetra executable.
+ *
+ * The command line is split into arguments and run by fork/exec, without a
+ * shell. The child's stdout and stderr are read through pipes; "1>file" and
+ * "2>file" redirections of the command line are performed by the supervisor,
+ * else the output goes to the standard streams of the parent. Lines of stdout
+ * are passed to a listener while the child runs. As soon as a cancel flag is
+ * set, the process group of the child is terminated by SIGTERM, then by SIGKILL
+ * if it is still alive after a delay.
+ */
+class MG_Tetra_Process
+{
+public:
+
+  //! Receiver of lines printed by the child to its stdout
+  struct LineListener
+  {
+    virtual ~LineListener() {}
+    virtual void OnLine( const std::string& line ) = 0;
+  };
+
+  MG_Tetra_Process();
+
+  void SetCancelFlag  ( volatile bool* isCancelled ) { _isCancelled = isCancelled; }
+  void SetLineListener( LineListener* listener ) { _listener = listener; }
+  void SetMemoryLimit ( size_t megaBytes ) { _memoryLimitMB = megaBytes; } // 0 - no limit
+  void SetKillDelay   ( int milliseconds ) { _killDelayMS = milliseconds; }
+
+  //! Run a command and wait for its end. Return true if it exits with zero status
+  bool Run( const std::string& cmdLine, std::string& errStr );
+
+  int  ExitCode() const { return _exitCode; } // -1 if the process did not exit normally
+  int  Signal()   const { return _signal; }   // signal terminating the process, 0 if none
+  bool IsKilled() const { return _isKilled; } // terminated on cancellation
+
+  //! Split a command line into arguments and output redirections
+  static void SplitCommand( const std::string&          cmdLine,
+                            std::vector< std::string >& args,
+                            std::string&                outFile,
+                            std::string&                errFile );
+
+private:
+
+  volatile bool* _isCancelled;
+  LineListener*  _listener;
+  size_t         _memoryLimitMB;
+  int            _killDelayMS;
+  int            _exitCode;
+  int            _signal;
+  bool           _isKilled;
+};
+
+#endif